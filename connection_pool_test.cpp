@@ -5,8 +5,43 @@
 #include <thread>
 #include <atomic>
 #include <iomanip>
+#include <fstream>
+#include <random>
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <string>
+#include <tuple>
 #include <sys/resource.h>
 
+// 查询类型
+enum class QueryKind {
+    PointSelect,     // 单行查询
+    BulkFetch,       // 多行取数
+    BatchedInsert,   // 数组绑定批量插入
+};
+
+static const size_t kQueryKinds = 3;
+
+static const char* query_kind_name(QueryKind kind) {
+    switch (kind) {
+    case QueryKind::PointSelect:   return "point_select";
+    case QueryKind::BulkFetch:     return "bulk_fetch";
+    case QueryKind::BatchedInsert: return "batched_insert";
+    }
+    return "unknown";
+}
+
+// 查询组合，按权重随机选择每次执行的查询类型
+struct QueryMix {
+    std::string name = "point_select";
+    unsigned point_select = 1;    // 单行查询权重
+    unsigned bulk_fetch = 0;      // 多行取数权重
+    unsigned batched_insert = 0;  // 批量插入权重
+    size_t bulk_rows = 1000;      // 每次多行取数的行数
+    size_t insert_batch = 100;    // 每次批量插入的行数
+};
+
 struct TestConfig {
     int total_queries;           // 总查询次数
     int max_threads;             // 最大线程数
@@ -14,38 +49,231 @@ struct TestConfig {
     bool use_connection_pool;    // 是否使用连接池
     std::string test_name;       // 测试名称
 
+    QueryMix mix;                // 查询组合
+    size_t idle_shards = 1;      // 连接池空闲分片数
+    size_t sample_interval_ms = 100;  // 连接池状态采样间隔
+
     // 连接字符串或配置
     odbc::ConnectionConfig connection_config;
 };
 
+// 对数线性分桶的延迟直方图(微秒)，每个2的幂区间再分32个子桶，相对误差约3%
+// 每个线程独立记录，不加锁，结束后合并
+class LatencyRecorder {
+public:
+    static const unsigned kSubBucketBits = 5;
+    static const size_t kSubBuckets = size_t(1) << kSubBucketBits;
+    static const size_t kBuckets = (64 - kSubBucketBits) * kSubBuckets;
+
+    LatencyRecorder() : counts_(kBuckets, 0) {}
+
+    void record(std::chrono::steady_clock::duration elapsed) {
+        auto us = std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count();
+        record_us(us > 0 ? static_cast<uint64_t>(us) : 0);
+    }
+
+    void record_us(uint64_t us) {
+        counts_[bucket_index(us)]++;
+        count_++;
+        sum_us_ += us;
+        max_us_ = std::max(max_us_, us);
+    }
+
+    void merge(const LatencyRecorder& other) {
+        for (size_t i = 0; i < kBuckets; ++i) {
+            counts_[i] += other.counts_[i];
+        }
+        count_ += other.count_;
+        sum_us_ += other.sum_us_;
+        max_us_ = std::max(max_us_, other.max_us_);
+    }
+
+    uint64_t count() const { return count_; }
+    uint64_t max_us() const { return max_us_; }
+    double mean_us() const { return count_ ? static_cast<double>(sum_us_) / count_ : 0.0; }
+
+    // 分位数(0-1)，返回所在桶的上界
+    uint64_t percentile_us(double q) const {
+        if (count_ == 0) {
+            return 0;
+        }
+        uint64_t target = static_cast<uint64_t>(std::ceil(q * count_));
+        target = std::max<uint64_t>(1, std::min(target, count_));
+        uint64_t seen = 0;
+        for (size_t i = 0; i < kBuckets; ++i) {
+            seen += counts_[i];
+            if (seen >= target) {
+                return std::min(bucket_upper_bound(i), max_us_);
+            }
+        }
+        return max_us_;
+    }
+
+private:
+    // 小于2^(kSubBucketBits+1)的值每个值一桶，之后每个2的幂区间kSubBuckets桶
+    static size_t bucket_index(uint64_t us) {
+        if (us < 2 * kSubBuckets) {
+            return static_cast<size_t>(us);
+        }
+        unsigned shift = 63 - __builtin_clzll(us) - kSubBucketBits;
+        return ((shift + 1) << kSubBucketBits) + static_cast<size_t>((us >> shift) - kSubBuckets);
+    }
+
+    static uint64_t bucket_upper_bound(size_t index) {
+        if (index < 2 * kSubBuckets) {
+            return index;
+        }
+        unsigned shift = static_cast<unsigned>(index >> kSubBucketBits) - 1;
+        uint64_t sub = (index & (kSubBuckets - 1)) + kSubBuckets;
+        return ((sub + 1) << shift) - 1;
+    }
+
+    std::vector<uint64_t> counts_;
+    uint64_t count_ = 0;
+    uint64_t sum_us_ = 0;
+    uint64_t max_us_ = 0;
+};
+
+// 单个线程的统计，线程结束后合并到PerformanceMetrics
+struct ThreadStats {
+    LatencyRecorder latency;        // 单次查询总耗时
+    LatencyRecorder borrow_wait;    // 获取连接耗时(直接连接时为建立连接耗时)
+    LatencyRecorder execute;        // 执行与取数耗时
+    LatencyRecorder by_kind[kQueryKinds];  // 各查询类型的总耗时
+    long long success_count = 0;
+    long long error_count = 0;
+};
+
+// 连接池状态采样
+struct PoolSample {
+    long long elapsed_ms;
+    odbc::ConnectionPool::PoolStatus status;
+};
+
 class PerformanceMetrics {
 public:
-    std::atomic<long long> total_time_ms{0};
-    std::atomic<int> success_count{0};
-    std::atomic<int> error_count{0};
+    long long total_time_ms = 0;
+    long long success_count = 0;
+    long long error_count = 0;
+    LatencyRecorder latency;
+    LatencyRecorder borrow_wait;
+    LatencyRecorder execute;
+    LatencyRecorder by_kind[kQueryKinds];
+    std::vector<PoolSample> timeline;
     std::chrono::steady_clock::time_point start_time;
-    
+
     void start() {
         start_time = std::chrono::steady_clock::now();
     }
-    
+
     void end() {
         auto end_time = std::chrono::steady_clock::now();
         total_time_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
             end_time - start_time).count();
     }
-    
+
+    void merge(const ThreadStats& stats) {
+        success_count += stats.success_count;
+        error_count += stats.error_count;
+        latency.merge(stats.latency);
+        borrow_wait.merge(stats.borrow_wait);
+        execute.merge(stats.execute);
+        for (size_t i = 0; i < kQueryKinds; ++i) {
+            by_kind[i].merge(stats.by_kind[i]);
+        }
+    }
+
+    double qps() const {
+        return total_time_ms > 0 ? (success_count * 1000.0) / total_time_ms : 0.0;
+    }
+
+    static void print_latency(const char* label, const LatencyRecorder& recorder) {
+        std::cout << label << ": 平均 " << std::fixed << std::setprecision(1) << recorder.mean_us()
+                  << " μs, p50 " << recorder.percentile_us(0.5)
+                  << ", p90 " << recorder.percentile_us(0.9)
+                  << ", p99 " << recorder.percentile_us(0.99)
+                  << ", p99.9 " << recorder.percentile_us(0.999)
+                  << ", max " << recorder.max_us() << " μs" << std::endl;
+    }
+
     void print_results(const TestConfig& config) {
-        double qps = (success_count * 1000.0) / total_time_ms;
         std::cout << "\n=== " << config.test_name << " 测试结果 ===" << std::endl;
         std::cout << "总查询次数: " << config.total_queries << std::endl;
         std::cout << "成功次数: " << success_count << std::endl;
         std::cout << "失败次数: " << error_count << std::endl;
         std::cout << "总耗时: " << total_time_ms << " ms" << std::endl;
-        std::cout << "QPS: " << std::fixed << std::setprecision(2) << qps << " 查询/秒" << std::endl;
-        std::cout << "平均延迟: " << std::fixed << std::setprecision(2) 
-                  << (total_time_ms * 1000.0 / success_count) << " μs" << std::endl;
+        std::cout << "QPS: " << std::fixed << std::setprecision(2) << qps() << " 查询/秒" << std::endl;
+        print_latency("查询延迟", latency);
+        print_latency(config.use_connection_pool ? "借用等待" : "建立连接", borrow_wait);
+        print_latency("执行耗时", execute);
+        for (size_t i = 0; i < kQueryKinds; ++i) {
+            if (by_kind[i].count() > 0) {
+                std::cout << "  " << query_kind_name(static_cast<QueryKind>(i))
+                          << ": " << by_kind[i].count() << " 次, p99 "
+                          << by_kind[i].percentile_us(0.99) << " μs" << std::endl;
+            }
+        }
+        if (!timeline.empty()) {
+            size_t peak_active = 0;
+            size_t peak_waiting = 0;
+            for (const auto& sample : timeline) {
+                peak_active = std::max(peak_active, sample.status.active_connections);
+                peak_waiting = std::max(peak_waiting, sample.status.waiting_requests);
+            }
+            std::cout << "连接池采样: " << timeline.size() << " 次, 峰值借出 " << peak_active
+                      << ", 峰值等待 " << peak_waiting << std::endl;
+        }
+    }
+};
+
+// 单个线程的查询执行器，按查询组合随机选择查询类型
+class QueryRunner {
+public:
+    QueryRunner(const QueryMix& mix, int thread_index)
+        : mix_(mix),
+          rng_(static_cast<unsigned>(thread_index) * 2654435761u + 1),
+          choose_({static_cast<double>(mix.point_select),
+                   static_cast<double>(mix.bulk_fetch),
+                   static_cast<double>(mix.batched_insert)}),
+          thread_index_(thread_index) {}
+
+    QueryKind next_kind() {
+        return static_cast<QueryKind>(choose_(rng_));
+    }
+
+    // Conn为odbc::Connection或odbc::PoolConnectionHandle
+    template<typename Conn>
+    bool run(Conn& conn, QueryKind kind) {
+        switch (kind) {
+        case QueryKind::PointSelect:
+            return !conn.query("SELECT 1 as test_value").empty();
+
+        case QueryKind::BulkFetch:
+            return conn.query(bulk_fetch_sql()).size() == mix_.bulk_rows;
+
+        case QueryKind::BatchedInsert: {
+            std::vector<int> workers(mix_.insert_batch, thread_index_);
+            std::vector<std::string> payloads(mix_.insert_batch, "connection pool test payload");
+            odbc::ParamBatch batch;
+            batch.add(workers).add(payloads);
+            // 预备语句必须在连接归还前释放
+            auto stmt = conn.prepare("INSERT INTO pool_test_rows (worker, payload) VALUES (?, ?)");
+            return stmt->execute_batch(batch).error_count() == 0;
+        }
+        }
+        return false;
+    }
+
+private:
+    std::string bulk_fetch_sql() const {
+        return "WITH RECURSIVE seq(n) AS (SELECT 1 UNION ALL SELECT n + 1 FROM seq WHERE n < "
+               + std::to_string(mix_.bulk_rows) + ") SELECT n FROM seq";
     }
+
+    QueryMix mix_;
+    std::mt19937 rng_;
+    std::discrete_distribution<int> choose_;
+    int thread_index_;
 };
 
 // 直接连接测试
@@ -53,42 +281,53 @@ class DirectConnectionTest {
 public:
     static void run_test(const TestConfig& config, PerformanceMetrics& metrics) {
         std::vector<std::thread> threads;
+        std::vector<ThreadStats> stats(config.max_threads);
         int queries_per_thread = config.total_queries / config.max_threads;
-        
+
         metrics.start();
-        
+
         for (int i = 0; i < config.max_threads; ++i) {
-            threads.emplace_back([&, queries_per_thread]() {
+            threads.emplace_back([&, i, queries_per_thread]() {
+                ThreadStats& local = stats[i];
+                QueryRunner runner(config.mix, i);
                 for (int j = 0; j < queries_per_thread; ++j) {
+                    QueryKind kind = runner.next_kind();
+                    auto start = std::chrono::steady_clock::now();
                     try {
-                        auto start = std::chrono::steady_clock::now();
-                        
                         // 每次创建新连接
                         odbc::Connection conn;
                         conn.connect(config.connection_config);
-                        
-                        // 执行简单查询
-                        auto result = conn.query("SELECT 1 as test_value");
-                        if (!result.empty()) {
-                            metrics.success_count++;
+                        auto connected = std::chrono::steady_clock::now();
+                        local.borrow_wait.record(connected - start);
+
+                        bool ok = runner.run(conn, kind);
+                        auto done = std::chrono::steady_clock::now();
+                        local.execute.record(done - connected);
+                        local.latency.record(done - start);
+                        local.by_kind[static_cast<size_t>(kind)].record(done - start);
+                        if (ok) {
+                            local.success_count++;
                         } else {
-                            metrics.error_count++;
+                            local.error_count++;
                         }
-                        
+
                         conn.disconnect();
-                        
+
                     } catch (const std::exception& e) {
-                        metrics.error_count++;
+                        local.error_count++;
                     }
                 }
             });
         }
-        
+
         for (auto& thread : threads) {
             thread.join();
         }
-        
+
         metrics.end();
+        for (const auto& local : stats) {
+            metrics.merge(local);
+        }
     }
 };
 
@@ -101,102 +340,324 @@ public:
         pool_config.min_connections = config.connection_pool_size;
         pool_config.max_connections = config.connection_pool_size;
         pool_config.connection_timeout = 30;
+        pool_config.idle_shards = config.idle_shards;
         pool_config.connection_config = config.connection_config;
-        
+
         auto pool = std::make_shared<odbc::ConnectionPool>(pool_config);
-        
+
         std::vector<std::thread> threads;
+        std::vector<ThreadStats> stats(config.max_threads);
         int queries_per_thread = config.total_queries / config.max_threads;
 
         metrics.start();
-        
+
+        // 定期采样连接池状态
+        std::atomic<bool> sampling{true};
+        std::thread sampler([&]() {
+            while (sampling) {
+                auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
+                    std::chrono::steady_clock::now() - metrics.start_time).count();
+                metrics.timeline.push_back(PoolSample{elapsed, pool->get_status()});
+                std::this_thread::sleep_for(std::chrono::milliseconds(config.sample_interval_ms));
+            }
+        });
+
         for (int i = 0; i < config.max_threads; ++i) {
-            threads.emplace_back([&, queries_per_thread]() {
+            threads.emplace_back([&, i, queries_per_thread]() {
+                ThreadStats& local = stats[i];
+                QueryRunner runner(config.mix, i);
                 for (int j = 0; j < queries_per_thread; ++j) {
+                    QueryKind kind = runner.next_kind();
+                    auto start = std::chrono::steady_clock::now();
                     try {
-                        auto start = std::chrono::steady_clock::now();
-                        
                         // 从连接池获取连接
                         auto conn = pool->get_connection();
-                        
-                        // 执行相同的查询
-                        auto result = conn->query("SELECT 1 as test_value");
-                        if (!result.empty()) {
-                            metrics.success_count++;
+                        auto borrowed = std::chrono::steady_clock::now();
+                        local.borrow_wait.record(borrowed - start);
+
+                        bool ok = runner.run(conn, kind);
+                        auto done = std::chrono::steady_clock::now();
+                        local.execute.record(done - borrowed);
+                        local.latency.record(done - start);
+                        local.by_kind[static_cast<size_t>(kind)].record(done - start);
+                        if (ok) {
+                            local.success_count++;
                         } else {
-                            metrics.error_count++;
+                            local.error_count++;
                         }
-                        
+
                         // 连接自动归还到池中
                     } catch (const std::exception& e) {
-                        metrics.error_count++;
+                        local.error_count++;
                     }
                 }
             });
         }
-        
+
         for (auto& thread : threads) {
             thread.join();
         }
-        
+
         metrics.end();
+        sampling = false;
+        sampler.join();
+        for (const auto& local : stats) {
+            metrics.merge(local);
+        }
         pool->shutdown();
     }
 };
 
 void print_comparison(const PerformanceMetrics& direct, const PerformanceMetrics& pool) {
-    double direct_qps = (direct.success_count * 1000.0) / direct.total_time_ms;
-    double pool_qps = (pool.success_count * 1000.0) / pool.total_time_ms;
+    double direct_qps = direct.qps();
+    double pool_qps = pool.qps();
     double improvement = ((pool_qps - direct_qps) / direct_qps) * 100;
-    
+
     std::cout << "\n=== 性能对比分析 ===" << std::endl;
-    std::cout << "连接池性能提升: " << std::fixed << std::setprecision(1) 
+    std::cout << "连接池性能提升: " << std::fixed << std::setprecision(1)
               << improvement << "%" << std::endl;
     std::cout << "吞吐量提升: " << std::fixed << std::setprecision(0)
               << (pool_qps - direct_qps) << " QPS" << std::endl;
     std::cout << "延迟降低: " << std::fixed << std::setprecision(1)
               << ((direct.total_time_ms - pool.total_time_ms) * 100.0 / direct.total_time_ms)
               << "%" << std::endl;
-    
+
     // 输出性能对比表格
     std::cout << "\n性能指标对比:" << std::endl;
     std::cout << "┌──────────────────┬────────────┬────────────┬──────────┐" << std::endl;
     std::cout << "│ 指标             │ 直接连接   │ 连接池     │ 提升     │" << std::endl;
     std::cout << "├──────────────────┼────────────┼────────────┼──────────┤" << std::endl;
-    std::cout << "│ 总耗时(ms)       │ " << std::setw(10) << direct.total_time_ms 
-              << " │ " << std::setw(10) << pool.total_time_ms 
+    std::cout << "│ 总耗时(ms)       │ " << std::setw(10) << direct.total_time_ms
+              << " │ " << std::setw(10) << pool.total_time_ms
               << " │ " << std::setw(8) << std::fixed << std::setprecision(1)
-              << (100.0 * (direct.total_time_ms - pool.total_time_ms) / direct.total_time_ms) 
+              << (100.0 * (direct.total_time_ms - pool.total_time_ms) / direct.total_time_ms)
               << "% │" << std::endl;
-    std::cout << "│ 成功率           │ " << std::setw(10) << direct.success_count 
-              << " │ " << std::setw(10) << pool.success_count 
+    std::cout << "│ 成功率           │ " << std::setw(10) << direct.success_count
+              << " │ " << std::setw(10) << pool.success_count
               << " │ " << std::setw(8) << "N/A" << " │" << std::endl;
     std::cout << "│ QPS              │ " << std::setw(10) << std::fixed << std::setprecision(0) << direct_qps
               << " │ " << std::setw(10) << pool_qps
-              << " │ " << std::setw(8) << std::fixed << std::setprecision(1) << improvement 
+              << " │ " << std::setw(8) << std::fixed << std::setprecision(1) << improvement
               << "% │" << std::endl;
+    std::cout << "│ p99延迟(μs)      │ " << std::setw(10) << direct.latency.percentile_us(0.99)
+              << " │ " << std::setw(10) << pool.latency.percentile_us(0.99)
+              << " │ " << std::setw(8) << "N/A" << " │" << std::endl;
     std::cout << "└──────────────────┴────────────┴────────────┴──────────┘" << std::endl;
 }
 
+// 测试结果汇总，写出JSON与CSV供脚本对比
+class TestReport {
+public:
+    explicit TestReport(const std::string& prefix) : prefix_(prefix) {}
+
+    void add(const std::string& scenario, const TestConfig& config, const PerformanceMetrics& metrics) {
+        runs_.push_back(Run{scenario, config, metrics});
+    }
+
+    // 写出<prefix>.json、<prefix>.csv与<prefix>_timeline.csv
+    void write() const {
+        write_json(prefix_ + ".json");
+        write_csv(prefix_ + ".csv");
+        write_timeline(prefix_ + "_timeline.csv");
+        std::cout << "\n测试结果已写入 " << prefix_ << ".json / .csv / _timeline.csv" << std::endl;
+    }
+
+private:
+    struct Run {
+        std::string scenario;
+        TestConfig config;
+        PerformanceMetrics metrics;
+    };
+
+    static std::string escape(const std::string& text) {
+        std::string out;
+        for (char c : text) {
+            switch (c) {
+            case '"':  out += "\\\""; break;
+            case '\\': out += "\\\\"; break;
+            case '\n': out += "\\n"; break;
+            default:
+                if (static_cast<unsigned char>(c) < 0x20) {
+                    char buf[8];
+                    snprintf(buf, sizeof(buf), "\\u%04x", c);
+                    out += buf;
+                } else {
+                    out += c;
+                }
+            }
+        }
+        return out;
+    }
+
+    static void write_latency_json(std::ostream& os, const LatencyRecorder& recorder) {
+        os << "{\"count\":" << recorder.count()
+           << ",\"mean_us\":" << std::fixed << std::setprecision(1) << recorder.mean_us()
+           << ",\"p50_us\":" << recorder.percentile_us(0.5)
+           << ",\"p90_us\":" << recorder.percentile_us(0.9)
+           << ",\"p99_us\":" << recorder.percentile_us(0.99)
+           << ",\"p999_us\":" << recorder.percentile_us(0.999)
+           << ",\"max_us\":" << recorder.max_us() << "}";
+    }
+
+    static void write_latency_csv(std::ostream& os, const LatencyRecorder& recorder) {
+        os << "," << recorder.percentile_us(0.5) << "," << recorder.percentile_us(0.9)
+           << "," << recorder.percentile_us(0.99) << "," << recorder.percentile_us(0.999)
+           << "," << recorder.max_us();
+    }
+
+    void write_json(const std::string& path) const {
+        std::ofstream os(path);
+        os << "{\"runs\":[";
+        for (size_t r = 0; r < runs_.size(); ++r) {
+            const Run& run = runs_[r];
+            const PerformanceMetrics& m = run.metrics;
+            os << (r ? "," : "") << "\n{\"scenario\":\"" << escape(run.scenario) << "\""
+               << ",\"name\":\"" << escape(run.config.test_name) << "\""
+               << ",\"mode\":\"" << (run.config.use_connection_pool ? "pool" : "direct") << "\""
+               << ",\"mix\":\"" << escape(run.config.mix.name) << "\""
+               << ",\"threads\":" << run.config.max_threads
+               << ",\"pool_size\":" << run.config.connection_pool_size
+               << ",\"idle_shards\":" << run.config.idle_shards
+               << ",\"driver_pooling\":" << (run.config.connection_config.driver_pooling ? "true" : "false")
+               << ",\"queries\":" << run.config.total_queries
+               << ",\"success\":" << m.success_count
+               << ",\"errors\":" << m.error_count
+               << ",\"elapsed_ms\":" << m.total_time_ms
+               << ",\"qps\":" << std::fixed << std::setprecision(2) << m.qps()
+               << ",\"latency\":";
+            write_latency_json(os, m.latency);
+            os << ",\"borrow_wait\":";
+            write_latency_json(os, m.borrow_wait);
+            os << ",\"execute\":";
+            write_latency_json(os, m.execute);
+            os << ",\"by_kind\":{";
+            bool first = true;
+            for (size_t i = 0; i < kQueryKinds; ++i) {
+                if (m.by_kind[i].count() == 0) {
+                    continue;
+                }
+                os << (first ? "" : ",") << "\"" << query_kind_name(static_cast<QueryKind>(i)) << "\":";
+                write_latency_json(os, m.by_kind[i]);
+                first = false;
+            }
+            os << "},\"timeline\":[";
+            for (size_t s = 0; s < m.timeline.size(); ++s) {
+                const auto& sample = m.timeline[s];
+                os << (s ? "," : "") << "{\"t_ms\":" << sample.elapsed_ms
+                   << ",\"total\":" << sample.status.total_connections
+                   << ",\"idle\":" << sample.status.idle_connections
+                   << ",\"active\":" << sample.status.active_connections
+                   << ",\"waiting\":" << sample.status.waiting_requests << "}";
+            }
+            os << "]}";
+        }
+        os << "\n]}\n";
+    }
+
+    void write_csv(const std::string& path) const {
+        std::ofstream os(path);
+        os << "scenario,name,mode,mix,threads,pool_size,idle_shards,driver_pooling,queries,success,errors,elapsed_ms,qps";
+        for (const char* group : {"latency", "borrow_wait", "execute"}) {
+            for (const char* stat : {"p50_us", "p90_us", "p99_us", "p999_us", "max_us"}) {
+                os << "," << group << "_" << stat;
+            }
+        }
+        os << "\n";
+        for (const auto& run : runs_) {
+            const PerformanceMetrics& m = run.metrics;
+            os << "\"" << run.scenario << "\",\"" << run.config.test_name << "\","
+               << (run.config.use_connection_pool ? "pool" : "direct") << "," << run.config.mix.name
+               << "," << run.config.max_threads << "," << run.config.connection_pool_size
+               << "," << run.config.idle_shards
+               << "," << (run.config.connection_config.driver_pooling ? 1 : 0)
+               << "," << run.config.total_queries
+               << "," << m.success_count << "," << m.error_count << "," << m.total_time_ms
+               << "," << std::fixed << std::setprecision(2) << m.qps();
+            write_latency_csv(os, m.latency);
+            write_latency_csv(os, m.borrow_wait);
+            write_latency_csv(os, m.execute);
+            os << "\n";
+        }
+    }
+
+    void write_timeline(const std::string& path) const {
+        std::ofstream os(path);
+        os << "scenario,t_ms,total,idle,active,waiting\n";
+        for (const auto& run : runs_) {
+            for (const auto& sample : run.metrics.timeline) {
+                os << "\"" << run.scenario << "\"," << sample.elapsed_ms
+                   << "," << sample.status.total_connections << "," << sample.status.idle_connections
+                   << "," << sample.status.active_connections << "," << sample.status.waiting_requests
+                   << "\n";
+            }
+        }
+    }
+
+    std::string prefix_;
+    std::vector<Run> runs_;
+};
+
 enum class LoadTestType {
     LightLoadTest,
     MediumLoadTest,
     HeavyLoadTest,
 };
 
+// 测试场景：负载级别、查询组合与连接池配置
+struct LoadScenario {
+    LoadTestType load = LoadTestType::LightLoadTest;
+    QueryMix mix;
+    size_t idle_shards = 1;
+    bool compare_direct = true;   // 是否同时测试直接连接作对比
+    bool driver_pooling = false;  // 直接连接是否使用驱动管理器连接池
+};
+
+// 测试数据库连接参数
+odbc::ConnectionConfig test_connection_config() {
+    odbc::ConnectionConfig connection_config;
+    connection_config.databaseType = odbc::DatabaseType::MARIADB;
+    connection_config.driver = "MariaDB";
+    connection_config.host = "127.0.0.1";
+    connection_config.port = 3306;
+    connection_config.username = "testuser";
+    connection_config.password = "123456";
+    connection_config.database = "testdb";
+    connection_config.charset = "utf8";
+    return connection_config;
+}
+
+// query_as以std::string读取定长列：整数、时间戳须按显示宽度取回完整文本
+void verify_text_columns() {
+    odbc::Connection conn;
+    conn.connect(test_connection_config());
+    conn.execute("CREATE TEMPORARY TABLE pool_test_types (i INT, b BIGINT, t DATETIME)");
+    conn.execute("INSERT INTO pool_test_types VALUES "
+                 "(-2147483648, -9223372036854775807, '2024-02-29 23:59:58')");
+
+    auto rows = conn.query_as<std::tuple<std::string, std::string, std::string>>(
+        "SELECT i, b, t FROM pool_test_types");
+    if (rows.size() != 1) {
+        throw std::runtime_error("query_as<std::string>: expected 1 row, got "
+                                 + std::to_string(rows.size()));
+    }
+    const auto& [i, b, t] = rows[0];
+    if (i != "-2147483648" || b != "-9223372036854775807"
+        || t.compare(0, 19, "2024-02-29 23:59:58") != 0) {
+        throw std::runtime_error("query_as<std::string>: got '" + i + "', '" + b + "', '" + t + "'");
+    }
+    conn.execute("DROP TEMPORARY TABLE pool_test_types");
+    std::cout << "query_as文本列检查通过" << std::endl;
+}
+
 // 负载测试
-void load_test(LoadTestType loadType) {
+void load_test(const LoadScenario& scenario, TestReport& report) {
     TestConfig config;
-    config.connection_config.databaseType = odbc::DatabaseType::MARIADB;
-    config.connection_config.driver = "MariaDB";
-    config.connection_config.host = "127.0.0.1";
-    config.connection_config.port = 3306;
-    config.connection_config.username = "testuser";
-    config.connection_config.password = "123456";
-    config.connection_config.database = "testdb";
-    config.connection_config.charset = "utf8";
-    
-    switch (loadType)
+    config.connection_config = test_connection_config();
+    config.connection_config.driver_pooling = scenario.driver_pooling;
+    config.mix = scenario.mix;
+    config.idle_shards = scenario.idle_shards;
+
+    switch (scenario.load)
     {
     case LoadTestType::LightLoadTest:
         {
@@ -224,30 +685,56 @@ void load_test(LoadTestType loadType) {
             config.test_name = "高负载压力测试(10000次查询)";
         }
         break;
-    
+
     default:
         break;
     }
-    
+
+    std::string scenario_name = config.test_name + " [" + config.mix.name
+                                + ", shards=" + std::to_string(config.idle_shards)
+                                + (scenario.driver_pooling ? ", driver_pooling" : "") + "]";
+    config.test_name = scenario_name;
+
+    // 批量插入使用的测试表
+    if (config.mix.batched_insert > 0) {
+        odbc::Connection conn;
+        conn.connect(config.connection_config);
+        conn.execute("CREATE TABLE IF NOT EXISTS pool_test_rows ("
+                     "id BIGINT AUTO_INCREMENT PRIMARY KEY, "
+                     "worker INT NOT NULL, payload VARCHAR(64) NOT NULL)");
+    }
+
     // 测试直接连接
     PerformanceMetrics direct_metrics;
-    config.use_connection_pool = false;
-    config.test_name += " - 直接连接";
-    DirectConnectionTest::run_test(config, direct_metrics);
-    direct_metrics.print_results(config);
-    
+    if (scenario.compare_direct) {
+        config.use_connection_pool = false;
+        config.test_name = scenario_name + " - 直接连接";
+        DirectConnectionTest::run_test(config, direct_metrics);
+        direct_metrics.print_results(config);
+        report.add(scenario_name, config, direct_metrics);
+    }
+
     // 测试连接池
     PerformanceMetrics pool_metrics;
     config.use_connection_pool = true;
-    config.test_name += " - 连接池";
+    config.test_name = scenario_name + " - 连接池";
 
     std::cout << "=========start to test pool=======" << std::endl;
     ConnectionPoolTest::run_test(config, pool_metrics);
     std::cout << "=========end to test pool=======" << std::endl;
     pool_metrics.print_results(config);
-    
+    report.add(scenario_name, config, pool_metrics);
+
     // 性能对比
-    print_comparison(direct_metrics, pool_metrics);
+    if (scenario.compare_direct) {
+        print_comparison(direct_metrics, pool_metrics);
+    }
+
+    if (config.mix.batched_insert > 0) {
+        odbc::Connection conn;
+        conn.connect(config.connection_config);
+        conn.execute("DROP TABLE IF EXISTS pool_test_rows");
+    }
 }
 
 class ResourceMonitor {
@@ -255,12 +742,12 @@ public:
     static void print_memory_usage() {
         struct rusage usage;
         getrusage(RUSAGE_SELF, &usage);
-        
+
         std::cout << "内存使用情况:" << std::endl;
         std::cout << "最大常驻集大小: " << usage.ru_maxrss / 1024 << " MB" << std::endl;
         std::cout << "页错误次数: " << usage.ru_majflt << std::endl;
     }
-    
+
     static void start_monitor() {
         std::thread monitor_thread([]() {
             while (true) {
@@ -272,24 +759,47 @@ public:
     }
 };
 
-int main() {
+// 用法: connection_pool_test [结果文件前缀]
+int main(int argc, char** argv) {
     std::cout << "开始ODBC连接池全方位压力测试..." << std::endl;
-    
+
+    TestReport report(argc > 1 ? argv[1] : "connection_pool_test_report");
+
+    QueryMix mixed;
+    mixed.name = "mixed";
+    mixed.point_select = 7;
+    mixed.bulk_fetch = 2;
+    mixed.batched_insert = 1;
+
+    // 场景矩阵：不同负载下的单行查询对比直接连接(含驱动管理器连接池)，再以混合查询比较连接池配置
+    std::vector<LoadScenario> scenarios;
+    scenarios.push_back(LoadScenario{LoadTestType::LightLoadTest, QueryMix(), 1, true});
+    scenarios.push_back(LoadScenario{LoadTestType::MediumLoadTest, QueryMix(), 1, true});
+    scenarios.push_back(LoadScenario{LoadTestType::HeavyLoadTest, QueryMix(), 1, true});
+    // 直接连接改用驱动管理器连接池，对比两种池化方式
+    scenarios.push_back(LoadScenario{LoadTestType::MediumLoadTest, QueryMix(), 1, true, true});
+    scenarios.push_back(LoadScenario{LoadTestType::HeavyLoadTest, mixed, 1, false});
+    scenarios.push_back(LoadScenario{LoadTestType::HeavyLoadTest, mixed, 8, false});
+
     try {
+        verify_text_columns();
+
         // 启动资源监控
         ResourceMonitor::start_monitor();
-        
+
         // 执行不同负载测试
-        load_test(LoadTestType::LightLoadTest);
-        load_test(LoadTestType::MediumLoadTest);
-        load_test(LoadTestType::HeavyLoadTest);
-        
+        for (const auto& scenario : scenarios) {
+            load_test(scenario, report);
+        }
+
+        report.write();
         std::cout << "\n=== 所有测试完成 ===" << std::endl;
-        
+
     } catch (const std::exception& e) {
         std::cerr << "测试过程中发生错误: " << e.what() << std::endl;
+        report.write();
         return 1;
     }
-    
+
     return 0;
 }
@@ -34,7 +34,7 @@ void concurrent_operations(std::shared_ptr<odbc::ConnectionPool> pool) {
                 auto stmt = conn->prepare("INSERT INTO logs(level, message) VALUES(?, ?)");
                 stmt->bind_param(1, infoStr);
                 stmt->bind_param(2, messageStr);
-                stmt->execute(); // 确保执行时，bind_param绑定的参数未被释放
+                stmt->execute(); // bind_param已复制参数值，实参无需保持到执行时
             } catch (const std::exception& e) {
                 std::cerr << "Thread " << i << " error: " << e.what() << std::endl;
             }
@@ -1,28 +1,150 @@
 #include "odbc_connection_pool.h"
 #include <algorithm>
-#include <iostream>
+#include <iterator>
+#include <random>
+#include <type_traits>
 
 namespace odbc {
 
-ConnectionPool::ConnectionPool(const ConnectionPoolConfig& config)
-    : config_(config) {
+namespace {
+
+// 执行中的语句都未完成时的轮询间隔
+constexpr std::chrono::microseconds kAsyncPollInterval(200);
+// 异步等待者超时检查间隔
+constexpr std::chrono::milliseconds kAsyncExpiryInterval(10);
+// 每个异步执行线程同时推进的语句数上限
+constexpr size_t kMaxInFlightPerWorker = 256;
+
+/**
+ * @brief 进程内所有连接池共享的建连并发上限
+ */
+class ConnectGate {
+public:
+    static ConnectGate& instance() {
+        static ConnectGate gate;
+        return gate;
+    }
     
-    // 初始化最小连接数
-    try {
-        for (size_t i = 0; i < config_.min_connections; ++i) {
-            auto conn = std::make_unique<Connection>(config_.connection_config);
-            idle_connections_.push(std::move(conn));
-            total_connections_++;
+    void set_limit(size_t limit) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        limit_ = limit;
+        cv_.notify_all();
+    }
+    
+    void acquire() {
+        std::unique_lock<std::mutex> lock(mutex_);
+        cv_.wait(lock, [this] { return limit_ == 0 || active_ < limit_; });
+        active_++;
+    }
+    
+    void release() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        active_--;
+        cv_.notify_one();
+    }
+    
+private:
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    size_t limit_ = 0;
+    size_t active_ = 0;
+};
+
+class ConnectPermit {
+public:
+    ConnectPermit() { ConnectGate::instance().acquire(); }
+    ~ConnectPermit() { ConnectGate::instance().release(); }
+    
+    ConnectPermit(const ConnectPermit&) = delete;
+    ConnectPermit& operator=(const ConnectPermit&) = delete;
+};
+
+// 熔断时长乘以[0.75, 1.25)的随机系数，避免多个连接池同时探测
+std::chrono::milliseconds with_jitter(std::chrono::milliseconds backoff) {
+    static thread_local std::minstd_rand rng(static_cast<unsigned>(
+        std::hash<std::thread::id>()(std::this_thread::get_id())));
+    std::uniform_real_distribution<double> factor(0.75, 1.25);
+    return std::chrono::milliseconds(static_cast<long long>(backoff.count() * factor(rng)));
+}
+
+// 通道配置必须让每个通道都能借到连接，否则其借用者只会超时
+void validate_lanes(const ConnectionPoolConfig& config) {
+    size_t reserved_total = 0;
+    for (const auto& lane : config.lanes) {
+        reserved_total += lane.reserved;
+    }
+    if (reserved_total > config.max_connections) {
+        throw std::invalid_argument("Connection pool lanes reserve more connections than max_connections");
+    }
+    for (size_t i = 0; i < config.lanes.size(); ++i) {
+        const LaneConfig& lane = config.lanes[i];
+        if (lane.limit > 0 && lane.limit < lane.reserved) {
+            throw std::invalid_argument("Connection pool lane " + std::to_string(i)
+                                        + " limit is below its reserved connections");
         }
+        if (config.max_connections - (reserved_total - lane.reserved) == 0) {
+            throw std::invalid_argument("Connection pool lane " + std::to_string(i)
+                                        + " has no connections left after other lanes' reservations");
+        }
+    }
+}
 
-        std::cout << "ConnectionPool init, idl_connections size: " << total_connections_ << std::endl;
-    } catch (const std::exception& e) {
-        std::cerr << "Warning: Failed to create initial connections: " 
-                  << e.what() << std::endl;
+} // namespace
+
+void ConnectionPool::set_global_connect_limit(size_t limit) {
+    ConnectGate::instance().set_limit(limit);
+}
+
+ConnectionPool::ConnectionPool(const ConnectionPoolConfig& config)
+    : config_(config)
+    , env_(Environment::create(config.connection_config.driver_pooling))
+    , metrics_(std::make_shared<PoolMetrics>())
+    , lane_active_(config.lanes.size()) {
+    
+    validate_lanes(config_);
+    
+    if (config_.result_cache_bytes > 0) {
+        result_cache_.reset(new ResultCache(config_.result_cache_bytes));
     }
     
+    // 初始化空闲连接分片
+    size_t shard_count = std::max<size_t>(1, config_.idle_shards);
+    for (size_t i = 0; i < shard_count; ++i) {
+        shards_.emplace_back(new IdleShard());
+    }
+    
+    // 预建连接计入建立中的连接，启动期间到来的借用者不会重复请求建连
+    ready_ = ready_promise_.get_future().share();
+    size_t prefill_count = std::min(config_.min_connections, config_.max_connections);
+    total_connections_ = prefill_count;
+    opens_in_flight_ = prefill_count;
+    
     // 启动后台线程
+    size_t opener_count = std::max<size_t>(1, config_.max_concurrent_connects);
+    for (size_t i = 0; i < opener_count; ++i) {
+        opener_threads_.emplace_back(&ConnectionPool::opener_task, this);
+    }
+    cleanup_thread_ = std::thread(&ConnectionPool::cleanup_task, this);
     health_check_thread_ = std::thread(&ConnectionPool::health_check_task, this);
+    target_connections_ = config_.min_connections;
+    if (config_.autoscale) {
+        autoscale_thread_ = std::thread(&ConnectionPool::autoscale_task, this);
+    }
+    
+    size_t prefill_threads = prefill_count == 0 ? 0
+        : std::min(prefill_count, std::max<size_t>(1, config_.prefill_concurrency));
+    if (prefill_threads == 0) {
+        ready_promise_.set_value();
+        return;
+    }
+    prefill_workers_ = prefill_threads;
+    for (size_t i = 0; i < prefill_threads; ++i) {
+        prefill_threads_.emplace_back(&ConnectionPool::prefill_task, this);
+    }
+    if (config_.wait_for_prefill
+        && !wait_ready(std::chrono::seconds(config_.connection_timeout))) {
+        ODBC_LOG_WARN("ConnectionPool prefill still running after connection_timeout");
+    }
 }
 
 ConnectionPool::~ConnectionPool() {
@@ -34,234 +156,1268 @@ void ConnectionPool::shutdown() {
         return; // 已经关闭
     }
     
-    // 通知所有等待的线程
-    condition_.notify_all();
+    // 唤醒所有等待的线程，异步等待者直接出队
+    std::vector<std::unique_ptr<AsyncTask>> cancelled;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (auto it = waiters_.begin(); it != waiters_.end();) {
+            Waiter* waiter = *it;
+            if (waiter->async) {
+                cancelled.push_back(std::move(waiter->async));
+                delete waiter;
+                it = waiters_.erase(it);
+                waiting_requests_--;
+            } else {
+                waiter->cv.notify_one();
+                ++it;
+            }
+        }
+    }
+    
+    // 停止异步执行线程，未开始的任务以失败结束
+    std::vector<std::thread> async_threads;
+    {
+        std::lock_guard<std::mutex> lock(async_mutex_);
+        async_stop_ = true;
+        async_threads.swap(async_threads_);
+        async_threads.insert(async_threads.end(),
+                             std::make_move_iterator(blocking_threads_.begin()),
+                             std::make_move_iterator(blocking_threads_.end()));
+        blocking_threads_.clear();
+    }
+    async_cv_.notify_all();
+    blocking_cv_.notify_all();
+    for (auto& worker : async_threads) {
+        // 回调中释放了最后一个引用时析构发生在异步执行线程上，该线程随后直接退出
+        if (worker.get_id() == std::this_thread::get_id()) {
+            worker.detach();
+        } else {
+            worker.join();
+        }
+    }
+    for (auto& task : async_ready_) {
+        cancelled.push_back(std::move(task));
+    }
+    async_ready_.clear();
+    for (auto& task : blocking_ready_) {
+        cancelled.push_back(std::move(task));
+    }
+    blocking_ready_.clear();
+    auto shutdown_error = std::make_exception_ptr(
+        std::runtime_error("Connection pool is shutdown"));
+    for (auto& task : cancelled) {
+        complete_async(*task, shutdown_error);
+    }
+    opener_cv_.notify_all();
+    cleanup_cv_.notify_all();
     
     // 等待后台线程结束
+    for (auto& prefill : prefill_threads_) {
+        if (prefill.joinable()) {
+            prefill.join();
+        }
+    }
+    for (auto& opener : opener_threads_) {
+        if (opener.joinable()) {
+            opener.join();
+        }
+    }
     if (cleanup_thread_.joinable()) {
         cleanup_thread_.join();
     }
     if (health_check_thread_.joinable()) {
         health_check_thread_.join();
     }
-    
-    // 关闭所有连接
-    std::lock_guard<std::mutex> lock(mutex_);
-    
-    // 关闭空闲连接
-    while (!idle_connections_.empty()) {
-        idle_connections_.pop();
+    if (autoscale_thread_.joinable()) {
+        autoscale_thread_.join();
     }
     
+    // 关闭空闲连接
     // 注意：活跃连接会在其析构时自动关闭
-    active_connections_.clear();
+    for (auto& shard : shards_) {
+        std::deque<Connection::Ptr> closing;
+        {
+            std::lock_guard<std::mutex> shard_lock(shard->mutex);
+            closing.swap(shard->connections);
+            idle_count_ -= closing.size();
+        }
+    }
 }
 
 PoolConnectionHandle::Ptr ConnectionPool::get_connection(
-    std::chrono::milliseconds timeout) {
+    std::chrono::milliseconds timeout, size_t lane) {
     
     if (shutdown_) {
         throw std::runtime_error("Connection pool is shutdown");
     }
+    if (lane_active_.empty()) {
+        lane = 0;
+    } else if (lane >= lane_active_.size()) {
+        throw std::invalid_argument("Connection pool lane out of range");
+    }
+    
+    auto start = std::chrono::steady_clock::now();
+    auto deadline = start + timeout;
+    Connection::Ptr conn;
+    
+    while (!conn) {
+        // 无人等待时直接从分片取连接，不经过全局锁
+        if (waiting_requests_ == 0 && lane_admit(lane)) {
+            conn = borrow_from_pool();
+            if (!conn) {
+                lane_release(lane);
+            }
+        }
+        if (!conn) {
+            // 移交连接时已占用通道名额
+            std::unique_lock<std::mutex> lock(mutex_);
+            conn = acquire_locked(lock, deadline, lane);
+        }
+        
+        // 检查连接是否有效，无效则丢弃后重新获取
+        if (config_.test_on_borrow && !validate_on_borrow(*conn)) {
+            total_connections_--;
+            metrics_->validation_failures.fetch_add(1, std::memory_order_relaxed);
+            conn.reset();
+            lane_release(lane);
+        }
+    }
+    
+    metrics_->borrow_wait.record(std::chrono::steady_clock::now() - start);
+    active_count_++;
+    return make_handle(std::move(conn), lane);
+}
+
+bool ConnectionPool::lane_admissible(size_t lane) const {
+    if (lane_active_.empty()) {
+        return true;
+    }
+    const LaneConfig& lane_config = config_.lanes[lane];
+    size_t active = lane_active_[lane].load(std::memory_order_relaxed);
+    if (lane_config.limit > 0 && active >= lane_config.limit) {
+        return false;
+    }
+    
+    // 其他通道尚未用满的保留连接不可借
+    size_t in_use = 0;
+    size_t held_back = 0;
+    for (size_t i = 0; i < lane_active_.size(); ++i) {
+        size_t lane_in_use = lane_active_[i].load(std::memory_order_relaxed);
+        in_use += lane_in_use;
+        if (i != lane && config_.lanes[i].reserved > lane_in_use) {
+            held_back += config_.lanes[i].reserved - lane_in_use;
+        }
+    }
+    return in_use + held_back < config_.max_connections;
+}
+
+bool ConnectionPool::lane_admit(size_t lane) {
+    if (lane_active_.empty()) {
+        return true;
+    }
+    // 保留量的检查在并发借用时是近似的，上限通过CAS严格保证
+    if (!lane_admissible(lane)) {
+        return false;
+    }
+    size_t limit = config_.lanes[lane].limit;
+    size_t current = lane_active_[lane].load(std::memory_order_relaxed);
+    do {
+        if (limit > 0 && current >= limit) {
+            return false;
+        }
+    } while (!lane_active_[lane].compare_exchange_weak(current, current + 1));
+    return true;
+}
+
+std::deque<ConnectionPool::Waiter*>::iterator ConnectionPool::select_waiter_locked() {
+    if (lane_active_.empty()) {
+        return waiters_.begin();
+    }
+    
+    // 有效优先级 = 通道优先级 - 已等待的提升级数，相同时先到先得
+    auto now = std::chrono::steady_clock::now();
+    auto best = waiters_.end();
+    long long best_priority = 0;
+    for (auto it = waiters_.begin(); it != waiters_.end(); ++it) {
+        Waiter* waiter = *it;
+        long long priority = config_.lanes[waiter->lane].priority;
+        if (config_.lane_aging_ms > 0) {
+            priority -= std::chrono::duration_cast<std::chrono::milliseconds>(
+                now - waiter->since).count() / static_cast<long long>(config_.lane_aging_ms);
+        }
+        if ((best == waiters_.end() || priority < best_priority)
+            && lane_admissible(waiter->lane)) {
+            best = it;
+            best_priority = priority;
+        }
+    }
+    if (best != waiters_.end() && !lane_admit((*best)->lane)) {
+        return waiters_.end();
+    }
+    return best;
+}
+
+Connection::Ptr ConnectionPool::acquire_locked(
+    std::unique_lock<std::mutex>& lock,
+    std::chrono::steady_clock::time_point deadline,
+    size_t lane) {
     
+    Waiter waiter;
+    waiter.lane = lane;
+    waiter.since = std::chrono::steady_clock::now();
+    waiters_.push_back(&waiter);
     waiting_requests_++;
     
-    auto start_time = std::chrono::steady_clock::now();
+    // 登记后再检查一次分片：与无锁归还路径竞争时，
+    // 要么这里看到刚归还的连接，要么归还方看到等待者
+    drain_idle_to_waiters_locked();
     
-    while (!shutdown_) {
-        // 尝试从池中获取连接
-        auto connHandle = borrow_from_pool();
-        if (connHandle) {
-            waiting_requests_--;
-            std::cout << "success to get conn handle" << std::endl;
-            
-            // 检查连接是否有效
-            if (config_.test_on_borrow && !connHandle->is_connected()) {
-                // 连接无效，尝试创建新连接
-                try {
-                    auto conn = std::make_unique<Connection>(config_.connection_config);
-                    // ✅ 使用 weak_ptr 捕获 ConnectionPool
-                    auto weak_pool = weak_from_this();
-                    
-                    // ✅ 使用 shared_ptr 捕获 PooledConnection
-                    auto release_func = [weak_pool](Connection::Ptr released_conn) {
-                        if (auto pool = weak_pool.lock()) {
-                            pool->return_connection(std::move(released_conn));
-                        } else {
-                            // ConnectionPool 已被销毁，连接会被自动清理
-                            // 可以记录日志或什么都不做
-                            std::cout << "connection pool already release." << std::endl;
-                        }
-                    };
-
-                    return std::make_unique<PoolConnectionHandle>(std::move(conn), std::move(release_func));
-                } catch (const std::exception& e) {
-                    throw std::runtime_error(
-                        std::string("Failed to create valid connection: ") + e.what());
+    // 新连接由后台建连线程创建，建好后直接移交给队首等待者；熔断期间不再请求
+    if (!waiter.conn && lane_admissible(lane)
+        && !circuit_rejecting_locked(std::chrono::steady_clock::now())) {
+        request_open_locked();
+    }
+    
+    // 熔断期间仍可等待借出的连接归还，只有等待者多于借出连接时才失败
+    bool rejected = false;
+    while (!waiter.conn && !shutdown_) {
+        if (circuit_rejects_waiter_locked(std::chrono::steady_clock::now())) {
+            rejected = true;
+            break;
+        }
+        if (waiter.cv.wait_until(lock, deadline) == std::cv_status::timeout) {
+            break;
+        }
+    }
+    
+    // 超时或关闭时等待者仍在队列中
+    if (!waiter.conn) {
+        auto it = std::find(waiters_.begin(), waiters_.end(), &waiter);
+        if (it != waiters_.end()) {
+            waiters_.erase(it);
+        }
+    }
+    waiting_requests_--;
+    
+    if (waiter.conn) {
+        return std::move(waiter.conn);
+    }
+    if (shutdown_) {
+        throw std::runtime_error("Connection pool is shutdown");
+    }
+    if (rejected) {
+        metrics_->circuit_rejections.fetch_add(1, std::memory_order_relaxed);
+        throw std::runtime_error("Database unavailable: connection circuit open");
+    }
+    metrics_->timeouts.fetch_add(1, std::memory_order_relaxed);
+    ODBC_LOG_DEBUG("Timeout waiting for database connection");
+    throw std::runtime_error("Timeout waiting for database connection");
+}
+
+size_t ConnectionPool::local_shard() const {
+    static thread_local size_t thread_hash =
+        std::hash<std::thread::id>()(std::this_thread::get_id());
+    return thread_hash % shards_.size();
+}
+
+Connection::Ptr ConnectionPool::borrow_from_pool() {
+    size_t home = local_shard();
+    
+    // 先取本线程分片，为空时依次从其他分片窃取
+    // 总是取最近归还的连接，让多余连接自然空闲并被回收
+    for (size_t i = 0; i < shards_.size(); ++i) {
+        IdleShard& shard = *shards_[(home + i) % shards_.size()];
+        Connection::Ptr conn;
+        {
+            std::lock_guard<std::mutex> shard_lock(shard.mutex);
+            while (!shard.connections.empty()) {
+                conn = std::move(shard.connections.back());
+                shard.connections.pop_back();
+                idle_count_--;
+                
+                if (conn->is_connected()) {
+                    break;
                 }
+                // 连接无效，减少计数
+                conn.reset();
+                total_connections_--;
+                metrics_->validation_failures.fetch_add(1, std::memory_order_relaxed);
+            }
+        }
+        if (conn) {
+            return conn;
+        }
+    }
+    
+    return nullptr;
+}
+
+void ConnectionPool::push_idle(Connection::Ptr conn, size_t shard_index) {
+    IdleShard& shard = *shards_[shard_index % shards_.size()];
+    std::lock_guard<std::mutex> shard_lock(shard.mutex);
+    shard.connections.push_back(std::move(conn));
+    idle_count_++;
+}
+
+void ConnectionPool::drain_idle_to_waiters_locked() {
+    while (!waiters_.empty()) {
+        auto conn = borrow_from_pool();
+        if (!conn) {
+            break;
+        }
+        if (!hand_off_locked(conn)) {
+            // 等待者的通道都已用满
+            push_idle(std::move(conn), local_shard());
+            break;
+        }
+    }
+}
+
+void ConnectionPool::request_open_locked() {
+    // 已在建立中的连接足够满足等待者时不再追加
+    if (shutdown_ || waiters_.size() <= opens_pending_ + opens_in_flight_) {
+        return;
+    }
+    if (total_connections_ >= config_.max_connections) {
+        return;
+    }
+    
+    // 预先占用连接数，避免并发建连超过max_connections
+    total_connections_++;
+    opens_pending_++;
+    opener_cv_.notify_one();
+}
+
+void ConnectionPool::refill_locked() {
+    if (circuit_rejecting_locked(std::chrono::steady_clock::now())) {
+        return;
+    }
+    size_t floor = std::min(config_.max_connections,
+                            std::max(config_.min_connections, target_connections_.load()));
+    while (!shutdown_ && total_connections_ < floor) {
+        total_connections_++;
+        opens_pending_++;
+        opener_cv_.notify_one();
+    }
+}
+
+void ConnectionPool::publish_locked(Connection::Ptr conn) {
+    if (!hand_off_locked(conn)) {
+        push_idle(std::move(conn), local_shard());
+    }
+}
+
+void ConnectionPool::prefill_task() {
+    size_t prefill_count = std::min(config_.min_connections, config_.max_connections);
+    size_t index;
+    while ((index = prefill_next_.fetch_add(1)) < prefill_count) {
+        Connection::Ptr conn;
+        auto backoff = std::chrono::milliseconds(config_.prefill_retry_backoff_ms);
+        for (size_t attempt = 0; !conn && !shutdown_; ++attempt) {
+            {
+                // 熔断后不再重试，缺少的连接由按需建连补足
+                std::lock_guard<std::mutex> lock(mutex_);
+                if (!connect_allowed_locked()) {
+                    break;
+                }
+            }
+            try {
+                conn = create_connection();
+                std::lock_guard<std::mutex> lock(mutex_);
+                record_connect_locked(true);
+            } catch (const std::exception& e) {
+                metrics_->connect_failures.fetch_add(1, std::memory_order_relaxed);
+                std::unique_lock<std::mutex> lock(mutex_);
+                record_connect_locked(false);
+                if (attempt >= config_.prefill_retries) {
+                    ODBC_LOG_WARN("Failed to create initial connection: " << e.what());
+                    break;
+                }
+                ODBC_LOG_DEBUG("Initial connection failed, retrying: " << e.what());
+                cleanup_cv_.wait_for(lock, backoff, [this] { return shutdown_.load(); });
+                backoff *= 2;
             }
-            
-            return connHandle;
         }
         
-        // 检查是否超时
-        auto elapsed = std::chrono::steady_clock::now() - start_time;
-        if (elapsed >= timeout) {
-            std::cout << "Timeout waiting for database connection" << std::endl;
-            waiting_requests_--;
-            throw std::runtime_error("Timeout waiting for database connection");
+        std::unique_lock<std::mutex> lock(mutex_);
+        opens_in_flight_--;
+        if (conn && !shutdown_) {
+            // 按序号分散到各分片
+            if (!hand_off_locked(conn)) {
+                push_idle(std::move(conn), index);
+            }
+            continue;
+        }
+        // 放弃的预建释放占用的连接数，交由按需建连补足
+        total_connections_--;
+        request_open_locked();
+        if (conn) {
+            lock.unlock();
+            conn.reset();
+        }
+    }
+    
+    // 最后结束的预建线程标记就绪
+    if (prefill_workers_.fetch_sub(1) == 1) {
+        ODBC_LOG_INFO("ConnectionPool init, idle connections: " << idle_count_);
+        ready_promise_.set_value();
+    }
+}
+
+void ConnectionPool::opener_task() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    
+    while (!shutdown_) {
+        // 探测进行中时其他建连等待探测结果
+        opener_cv_.wait(lock, [this] {
+            return (opens_pending_ > 0 && circuit_state_ != CircuitState::HalfOpen) || shutdown_;
+        });
+        if (shutdown_) {
+            break;
+        }
+        
+        opens_pending_--;
+        if (!connect_allowed_locked()) {
+            // 熔断中，放弃本次建连并释放占用的连接数
+            total_connections_--;
+            continue;
+        }
+        opens_in_flight_++;
+        lock.unlock();
+        
+        // 在锁外完成建连握手
+        Connection::Ptr conn;
+        try {
+            conn = create_connection();
+        } catch (const std::exception& e) {
+            metrics_->connect_failures.fetch_add(1, std::memory_order_relaxed);
+            ODBC_LOG_WARN("Failed to open connection: " << e.what());
+        }
+        
+        lock.lock();
+        opens_in_flight_--;
+        if (!shutdown_) {
+            record_connect_locked(conn != nullptr);
         }
         
-        // 等待一段时间再重试
-        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        if (conn && !shutdown_) {
+            publish_locked(std::move(conn));
+            continue;
+        }
+        
+        // 建连失败或已关闭，释放占用的连接数
+        total_connections_--;
+        if (!conn && !shutdown_ && circuit_state_ == CircuitState::Closed) {
+            // 未达到熔断阈值，短暂退避后为仍在等待的借用者重试
+            opener_cv_.wait_for(lock, std::chrono::milliseconds(100),
+                                [this] { return shutdown_.load(); });
+            request_open_locked();
+        }
+        if (conn) {
+            lock.unlock();
+            conn.reset();
+            lock.lock();
+        }
+    }
+}
+
+bool ConnectionPool::connect_allowed_locked() {
+    switch (circuit_state_) {
+        case CircuitState::Closed:
+            return true;
+        case CircuitState::Open:
+            if (std::chrono::steady_clock::now() < circuit_open_until_) {
+                return false;
+            }
+            // 熔断到期，本次建连作为探测
+            circuit_state_ = CircuitState::HalfOpen;
+            ODBC_LOG_INFO("Connection circuit half-open, probing database");
+            return true;
+        default:
+            return false;
+    }
+}
+
+void ConnectionPool::record_connect_locked(bool success) {
+    if (config_.circuit_failure_threshold == 0) {
+        return;
     }
     
-    waiting_requests_--;
-    throw std::runtime_error("Connection pool is shutdown");
+    if (success) {
+        consecutive_connect_failures_ = 0;
+        if (circuit_state_ != CircuitState::Closed) {
+            circuit_state_ = CircuitState::Closed;
+            circuit_backoff_ = std::chrono::milliseconds(0);
+            circuit_open_ = false;
+            ODBC_LOG_INFO("Connection circuit closed");
+            opener_cv_.notify_all();
+        }
+        return;
+    }
+    
+    consecutive_connect_failures_++;
+    bool trip = circuit_state_ == CircuitState::HalfOpen
+        || (circuit_state_ == CircuitState::Closed
+            && consecutive_connect_failures_ >= config_.circuit_failure_threshold);
+    if (!trip) {
+        return;
+    }
+    
+    circuit_backoff_ = circuit_backoff_.count() == 0
+        ? std::chrono::milliseconds(config_.circuit_open_ms)
+        : std::min(circuit_backoff_ * 2, std::chrono::milliseconds(config_.circuit_max_open_ms));
+    circuit_open_until_ = std::chrono::steady_clock::now() + with_jitter(circuit_backoff_);
+    circuit_state_ = CircuitState::Open;
+    circuit_open_ = true;
+    ODBC_LOG_WARN("Connection circuit open for " << circuit_backoff_.count()
+                  << "ms after " << consecutive_connect_failures_ << " connect failures");
+    
+    // 等不到归还连接的借用者立即失败，异步等待者由异步执行线程清理
+    opener_cv_.notify_all();
+    wake_sync_waiters_locked();
 }
 
-PoolConnectionHandle::Ptr ConnectionPool::borrow_from_pool() {
-    std::lock_guard<std::mutex> lock(mutex_);
+void ConnectionPool::wake_sync_waiters_locked() {
+    for (Waiter* waiter : waiters_) {
+        if (!waiter->async) {
+            waiter->cv.notify_one();
+        }
+    }
+}
+
+bool ConnectionPool::hand_off_locked(Connection::Ptr& conn) {
+    if (waiters_.empty()) {
+        return false;
+    }
     
-    std::cout << "start borrow_from_pool idl_connections size: " << idle_connections_.size() << std::endl;
-    if (!idle_connections_.empty()) {
-        // 从空闲队列获取连接
-        auto conn = std::move(idle_connections_.front());
-        idle_connections_.pop();
+    auto selected = select_waiter_locked();
+    if (selected == waiters_.end()) {
+        return false;
+    }
+    Waiter* waiter = *selected;
+    waiters_.erase(selected);
+    if (waiter->async) {
+        // 异步等待者没有线程在等，连接随任务交给异步执行线程
+        std::unique_ptr<AsyncTask> task = std::move(waiter->async);
+        delete waiter;
+        waiting_requests_--;
+        active_count_++;
+        task->conn = std::move(conn);
+        enqueue_async(std::move(task));
+        return true;
+    }
+    waiter->conn = std::move(conn);
+    waiter->cv.notify_one();
+    return true;
+}
+
+void ConnectionPool::async_query(const std::string& sql, QueryCallback callback,
+                                 std::chrono::milliseconds timeout) {
+    std::unique_ptr<AsyncTask> task(new AsyncTask());
+    task->sql = sql;
+    task->on_query = std::move(callback);
+    task->submit_time = std::chrono::steady_clock::now();
+    task->deadline = task->submit_time + timeout;
+    submit_async(std::move(task));
+}
+
+std::future<ResultSet> ConnectionPool::async_query(const std::string& sql,
+                                                   std::chrono::milliseconds timeout) {
+    auto promise = std::make_shared<std::promise<ResultSet>>();
+    auto future = promise->get_future();
+    async_query(sql, [promise](std::exception_ptr error, ResultSet result) {
+        if (error) {
+            promise->set_exception(error);
+        } else {
+            promise->set_value(std::move(result));
+        }
+    }, timeout);
+    return future;
+}
+
+void ConnectionPool::async_execute(const std::string& sql, ExecuteCallback callback,
+                                   std::chrono::milliseconds timeout) {
+    std::unique_ptr<AsyncTask> task(new AsyncTask());
+    task->sql = sql;
+    task->on_execute = std::move(callback);
+    task->submit_time = std::chrono::steady_clock::now();
+    task->deadline = task->submit_time + timeout;
+    submit_async(std::move(task));
+}
+
+std::future<size_t> ConnectionPool::async_execute(const std::string& sql,
+                                                  std::chrono::milliseconds timeout) {
+    auto promise = std::make_shared<std::promise<size_t>>();
+    auto future = promise->get_future();
+    async_execute(sql, [promise](std::exception_ptr error, size_t affected_rows) {
+        if (error) {
+            promise->set_exception(error);
+        } else {
+            promise->set_value(affected_rows);
+        }
+    }, timeout);
+    return future;
+}
+
+void ConnectionPool::submit_async(std::unique_ptr<AsyncTask> task) {
+    {
+        // 首次使用时启动异步执行线程，它们同时负责异步等待者的超时
+        std::lock_guard<std::mutex> lock(async_mutex_);
+        if (!async_stop_ && async_threads_.empty()) {
+            size_t worker_count = std::max<size_t>(1, config_.async_threads);
+            for (size_t i = 0; i < worker_count; ++i) {
+                async_threads_.emplace_back(&ConnectionPool::async_worker, this);
+            }
+        }
+    }
+    
+    if (shutdown_) {
+        complete_async(*task, std::make_exception_ptr(
+            std::runtime_error("Connection pool is shutdown")));
+        return;
+    }
+    
+    if (waiting_requests_ == 0 && lane_admit(task->lane)) {
+        if (auto conn = borrow_from_pool()) {
+            active_count_++;
+            task->conn = std::move(conn);
+            enqueue_async(std::move(task));
+            return;
+        }
+        lane_release(task->lane);
+    }
+    
+    std::unique_lock<std::mutex> lock(mutex_);
+    if (shutdown_) {
+        lock.unlock();
+        complete_async(*task, std::make_exception_ptr(
+            std::runtime_error("Connection pool is shutdown")));
+        return;
+    }
+    Waiter* waiter = new Waiter();
+    waiter->deadline = task->deadline;
+    waiter->lane = task->lane;
+    waiter->since = std::chrono::steady_clock::now();
+    waiter->async = std::move(task);
+    waiters_.push_back(waiter);
+    waiting_requests_++;
+    
+    // 与同步等待者相同：登记后再检查一次分片，否则请求后台建连
+    // 熔断期间不请求建连，等待者由expire_async_waiters以失败结束
+    drain_idle_to_waiters_locked();
+    if (std::find(waiters_.begin(), waiters_.end(), waiter) != waiters_.end()
+        && !circuit_rejecting_locked(std::chrono::steady_clock::now())) {
+        request_open_locked();
+    }
+}
+
+void ConnectionPool::enqueue_async(std::unique_ptr<AsyncTask> task) {
+    {
+        std::lock_guard<std::mutex> lock(async_mutex_);
+        async_ready_.push_back(std::move(task));
+    }
+    async_cv_.notify_one();
+}
+
+void ConnectionPool::async_worker() {
+    std::vector<std::unique_ptr<AsyncTask>> in_flight;
+    auto next_expiry = std::chrono::steady_clock::now() + kAsyncExpiryInterval;
+    
+    // 回调可能释放连接池的最后一个引用。处理任务期间持有强引用，
+    // 使析构推迟到本线程没有执行中任务时，并在析构后不再访问this
+    std::weak_ptr<ConnectionPool> weak_self = weak_from_this();
+    std::shared_ptr<ConnectionPool> self;
+    
+    while (true) {
+        std::vector<std::unique_ptr<AsyncTask>> incoming;
+        {
+            std::unique_lock<std::mutex> lock(async_mutex_);
+            if (in_flight.empty()) {
+                async_cv_.wait_for(lock, kAsyncExpiryInterval,
+                                   [this] { return !async_ready_.empty() || async_stop_; });
+            }
+            if (async_stop_) {
+                break;
+            }
+            if (!self) {
+                self = weak_self.lock();
+            }
+            while (!async_ready_.empty()
+                   && in_flight.size() + incoming.size() < kMaxInFlightPerWorker) {
+                incoming.push_back(std::move(async_ready_.front()));
+                async_ready_.pop_front();
+            }
+        }
+        bool progressed = !incoming.empty();
         
-        if (conn->is_connected()) {
-            active_connections_.insert(std::move(conn));
-            // ✅ 使用 weak_ptr 捕获 ConnectionPool
-            auto weak_pool = weak_from_this();
-            
-            // ✅ 使用 shared_ptr 捕获 PooledConnection
-            auto release_func = [weak_pool](Connection::Ptr released_conn) {
-                if (auto pool = weak_pool.lock()) {
-                    pool->return_connection(std::move(released_conn));
-                } else {
-                    // ConnectionPool 已被销毁，连接会被自动清理
-                    // 可以记录日志或什么都不做
-                    std::cout << "connection pool already release." << std::endl;
+        // 开始新移交的任务，阻塞执行线程已开始的任务直接轮询
+        // ping与同步执行会阻塞本线程上所有执行中的语句和等待者超时，交给阻塞执行线程
+        for (auto& task : incoming) {
+            if (!task->stmt) {
+                if (config_.test_on_borrow && borrow_ping_needed(*task->conn)) {
+                    enqueue_blocking(std::move(task));
+                    continue;
                 }
-            };
-            return std::make_unique<PoolConnectionHandle>(std::move(conn), std::move(release_func));
-        } else {
-            // 连接无效，减少计数
-            total_connections_--;
+                if (!start_async(task)) {
+                    continue;
+                }
+                if (!task->stmt->is_async()) {
+                    enqueue_blocking(std::move(task));
+                    continue;
+                }
+            }
+            in_flight.push_back(std::move(task));
+        }
+        
+        // 推进所有执行中的语句
+        for (size_t i = 0; i < in_flight.size();) {
+            AsyncTask& task = *in_flight[i];
+            std::exception_ptr error;
+            bool done = true;
+            try {
+                done = task.stmt->poll();
+            } catch (...) {
+                error = std::current_exception();
+            }
+            if (!done) {
+                ++i;
+                continue;
+            }
+            // 取结果集可能很慢，交给阻塞执行线程；只取影响行数的直接完成
+            if (!error && task.on_query) {
+                task.executed = true;
+                enqueue_blocking(std::move(in_flight[i]));
+            } else {
+                complete_async(task, error);
+            }
+            in_flight[i] = std::move(in_flight.back());
+            in_flight.pop_back();
+            progressed = true;
+        }
+        
+        auto now = std::chrono::steady_clock::now();
+        if (now >= next_expiry) {
+            expire_async_waiters();
+            next_expiry = now + kAsyncExpiryInterval;
+        }
+        if (!progressed && !in_flight.empty()) {
+            std::this_thread::sleep_for(kAsyncPollInterval);
+        }
+        
+        if (self && in_flight.empty()) {
+            self.reset();
+            if (weak_self.expired()) {
+                return;  // 连接池已在本线程析构
+            }
         }
     }
     
-    std::cout << "start borrow_from_pool total_connections_: " << total_connections_ << "config_.max_connections: " << config_.max_connections << std::endl;
-    // 尝试创建新连接
-    if (total_connections_ < config_.max_connections) {
-        try {
-            auto conn = std::make_unique<Connection>(config_.connection_config);
-            active_connections_.insert(std::move(conn));
-            total_connections_++;
-            // ✅ 使用 weak_ptr 捕获 ConnectionPool
-            auto weak_pool = weak_from_this();
-            
-            // ✅ 使用 shared_ptr 捕获 PooledConnection
-            auto release_func = [weak_pool](Connection::Ptr released_conn) {
-                if (auto pool = weak_pool.lock()) {
-                    pool->return_connection(std::move(released_conn));
-                } else {
-                    // ConnectionPool 已被销毁，连接会被自动清理
-                    // 可以记录日志或什么都不做
-                    std::cout << "connection pool already release." << std::endl;
+    auto shutdown_error = std::make_exception_ptr(
+        std::runtime_error("Connection pool is shutdown"));
+    for (auto& task : in_flight) {
+        complete_async(*task, shutdown_error);
+    }
+}
+
+bool ConnectionPool::start_async(std::unique_ptr<AsyncTask>& task) {
+    if (config_.test_on_borrow && !validate_on_borrow(*task->conn)) {
+        task->conn.reset();
+        active_count_--;
+        lane_release(task->lane);
+        total_connections_--;
+        metrics_->validation_failures.fetch_add(1, std::memory_order_relaxed);
+        submit_async(std::move(task));
+        return false;
+    }
+    task->checkout_time = std::chrono::steady_clock::now();
+    metrics_->borrow_wait.record(task->checkout_time - task->submit_time);
+    try {
+        task->stmt = task->conn->begin_async(task->sql);
+    } catch (...) {
+        complete_async(*task, std::current_exception());
+        return false;
+    }
+    return true;
+}
+
+void ConnectionPool::enqueue_blocking(std::unique_ptr<AsyncTask> task) {
+    {
+        std::lock_guard<std::mutex> lock(async_mutex_);
+        if (!async_stop_) {
+            blocking_ready_.push_back(std::move(task));
+            if (blocking_ready_.size() > blocking_idle_
+                && blocking_threads_.size() < std::max<size_t>(1, config_.max_connections)) {
+                blocking_threads_.emplace_back(&ConnectionPool::blocking_worker, this);
+            }
+        }
+    }
+    if (task) {
+        complete_async(*task, std::make_exception_ptr(
+            std::runtime_error("Connection pool is shutdown")));
+        return;
+    }
+    blocking_cv_.notify_one();
+}
+
+void ConnectionPool::blocking_worker() {
+    // 与async_worker相同，执行任务期间持有强引用
+    std::weak_ptr<ConnectionPool> weak_self = weak_from_this();
+    
+    while (true) {
+        std::unique_ptr<AsyncTask> task;
+        std::shared_ptr<ConnectionPool> self;
+        {
+            std::unique_lock<std::mutex> lock(async_mutex_);
+            blocking_idle_++;
+            blocking_cv_.wait(lock, [this] { return !blocking_ready_.empty() || async_stop_; });
+            blocking_idle_--;
+            if (async_stop_) {
+                return;  // 未开始的任务由shutdown以失败结束
+            }
+            task = std::move(blocking_ready_.front());
+            blocking_ready_.pop_front();
+            self = weak_self.lock();
+        }
+        
+        // 借用ping后开始执行，驱动支持异步时交回异步执行线程轮询
+        if (!task->stmt) {
+            if (!start_async(task)) {
+                task.reset();
+            } else if (task->stmt->is_async()) {
+                enqueue_async(std::move(task));
+            }
+        }
+        if (task) {
+            std::exception_ptr error;
+            if (!task->executed) {
+                try {
+                    task->stmt->poll();
+                } catch (...) {
+                    error = std::current_exception();
                 }
-            };
-            return std::make_unique<PoolConnectionHandle>(std::move(conn), std::move(release_func));
-        } catch (const std::exception&) {
-            // 创建失败，返回空指针
+            }
+            complete_async(*task, error);
+            task.reset();
+        }
+        
+        if (self) {
+            self.reset();
+            if (weak_self.expired()) {
+                return;  // 连接池已在本线程析构
+            }
+        }
+    }
+}
+
+void ConnectionPool::complete_async(AsyncTask& task, std::exception_ptr error) {
+    ResultSet result;
+    size_t affected_rows = 0;
+    if (!error && task.stmt) {
+        try {
+            if (task.on_query) {
+                result = task.stmt->fetch_results();
+            } else {
+                affected_rows = task.stmt->row_count();
+            }
+        } catch (...) {
+            error = std::current_exception();
         }
     }
     
-    return nullptr;
+    // 先释放语句与连接，回调中可以继续发起异步请求
+    task.stmt.reset();
+    if (task.conn) {
+        metrics_->hold_time.record(std::chrono::steady_clock::now() - task.checkout_time);
+        return_connection(std::move(task.conn), task.lane);
+    }
+    
+    try {
+        if (task.on_query) {
+            task.on_query(error, std::move(result));
+        } else if (task.on_execute) {
+            task.on_execute(error, affected_rows);
+        }
+    } catch (const std::exception& e) {
+        ODBC_LOG_ERROR("Async callback threw: " << e.what());
+    } catch (...) {
+        ODBC_LOG_ERROR("Async callback threw an unknown exception");
+    }
+}
+
+void ConnectionPool::expire_async_waiters() {
+    std::vector<std::unique_ptr<AsyncTask>> expired;
+    std::vector<std::unique_ptr<AsyncTask>> rejected;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto now = std::chrono::steady_clock::now();
+        // 从队尾开始，熔断时先拒绝最晚到达的等待者，直到归还的连接足够分配
+        for (size_t i = waiters_.size(); i-- > 0;) {
+            Waiter* waiter = waiters_[i];
+            if (!waiter->async) {
+                continue;
+            }
+            bool reject = circuit_rejects_waiter_locked(now);
+            if (!reject && waiter->deadline > now) {
+                continue;
+            }
+            (reject ? rejected : expired).push_back(std::move(waiter->async));
+            delete waiter;
+            waiters_.erase(waiters_.begin() + i);
+            waiting_requests_--;
+        }
+    }
+    
+    if (!expired.empty()) {
+        metrics_->timeouts.fetch_add(expired.size(), std::memory_order_relaxed);
+        auto timeout_error = std::make_exception_ptr(
+            std::runtime_error("Timeout waiting for database connection"));
+        for (auto& task : expired) {
+            complete_async(*task, timeout_error);
+        }
+    }
+    if (!rejected.empty()) {
+        metrics_->circuit_rejections.fetch_add(rejected.size(), std::memory_order_relaxed);
+        auto circuit_error = std::make_exception_ptr(
+            std::runtime_error("Database unavailable: connection circuit open"));
+        for (auto& task : rejected) {
+            complete_async(*task, circuit_error);
+        }
+    }
+}
+
+PoolConnectionHandle::Ptr ConnectionPool::make_handle(Connection::Ptr conn, size_t lane) {
+    // weak_ptr只增加弱引用计数，不分配内存
+    return PoolConnectionHandle(std::move(conn), weak_from_this(),
+                                std::chrono::steady_clock::now(), lane);
 }
 
-void ConnectionPool::return_connection(std::unique_ptr<Connection> conn) {
-    std::cout << "========return_connection=========" << std::endl;
-    if (!conn || shutdown_) {
+void ConnectionPool::return_connection(std::unique_ptr<Connection> conn, size_t lane) {
+    if (!conn) {
         return;
     }
     
-    std::lock_guard<std::mutex> lock(mutex_);
+    active_count_--;
+    lane_release(lane);
+    if (shutdown_) {
+        return;
+    }
     
-    // 从活跃集合中移除
-    active_connections_.erase(conn);
+    // 回滚借用者遗留的事务，没有未提交的工作时不访问服务器
+    bool session_ok = true;
+    try {
+        conn->reset_session();
+    } catch (const std::exception& e) {
+        ODBC_LOG_WARN("Failed to reset session on return: " << e.what());
+        session_ok = false;
+    }
     
     // 检查连接是否仍然有效
-    if (config_.test_on_return && !conn->is_connected()) {
+    if (!session_ok || (config_.test_on_return && !conn->is_connected())) {
+        conn.reset();
         total_connections_--;
+        metrics_->validation_failures.fetch_add(1, std::memory_order_relaxed);
+        if (waiting_requests_ > 0) {
+            std::lock_guard<std::mutex> lock(mutex_);
+            // 熔断期间不会建连，可归还的连接减少了，让等待者重新判断
+            if (circuit_rejecting_locked(std::chrono::steady_clock::now())) {
+                wake_sync_waiters_locked();
+            } else {
+                request_open_locked();
+            }
+        }
         return; // 连接无效，直接销毁
     }
     
-    // 检查连接是否空闲超时
-    // if (conn->is_idle_timeout(config_.max_idle_time)) {
-    //     total_connections_--;
-    //     return; // 连接超时，直接销毁
-    // }
+    // 记录归还时间，空闲超时由cleanup_task回收
+    conn->update_last_used();
     
-    // 将连接放回空闲队列
-    // conn->update_last_used();
-
-    std::cout << "resturn_connection idle_connections_ size: " << idle_connections_.size() << std::endl;
-    idle_connections_.push(std::move(conn));
+    ODBC_LOG_TRACE("return_connection, idle connections: " << idle_count_);
+    if (waiting_requests_ == 0) {
+        // 无人等待时只锁本线程分片
+        push_idle(std::move(conn), local_shard());
+        if (waiting_requests_ == 0) {
+            return;
+        }
+        // 放回期间有借用者开始等待，移交给它
+        std::lock_guard<std::mutex> lock(mutex_);
+        drain_idle_to_waiters_locked();
+        return;
+    }
     
-    // 通知等待的线程
-    condition_.notify_one();
+    // 有等待者时直接移交给最早的等待者
+    std::lock_guard<std::mutex> lock(mutex_);
+    publish_locked(std::move(conn));
 }
 
 std::unique_ptr<Connection> ConnectionPool::create_connection() {
-    auto conn = std::make_unique<Connection>();
-    conn->connect(config_.connection_config);
+    std::unique_ptr<Connection> conn;
+    {
+        ConnectPermit permit;
+        auto start = std::chrono::steady_clock::now();
+        conn = config_.connection_factory
+            ? config_.connection_factory(config_.connection_config, env_)
+            : std::make_unique<Connection>(config_.connection_config, env_);
+        if (!conn) {
+            throw std::runtime_error("Connection factory returned null");
+        }
+        metrics_->connect_time.record(std::chrono::steady_clock::now() - start);
+    }
+    
+    conn->set_statement_cache_capacity(config_.statement_cache_size);
+    conn->set_metrics(std::shared_ptr<StatementMetrics>(metrics_, &metrics_->statements));
+    
+    // 会话初始化只在建连时执行一次，借用时不再重复
+    for (const auto& sql : config_.warm_statements) {
+        conn->prepare(sql);
+    }
+    if (config_.on_connect) {
+        config_.on_connect(*conn);
+    }
     return conn;
 }
 
+// 路由每次读借用都会查询各副本状态，快照必须保持平凡可复制、不做堆分配
+static_assert(std::is_trivially_copyable<ConnectionPool::PoolStatus>::value,
+              "PoolStatus must stay trivially copyable");
+
 ConnectionPool::PoolStatus ConnectionPool::get_status() const {
-    std::lock_guard<std::mutex> lock(mutex_);
-    
+    // 各计数器独立读取，并发借还时可能存在瞬时偏差
     return PoolStatus{
         .total_connections = total_connections_,
-        .idle_connections = idle_connections_.size(),
-        .active_connections = active_connections_.size(),
-        .waiting_requests = waiting_requests_
+        .idle_connections = idle_count_,
+        .active_connections = active_count_,
+        .waiting_requests = waiting_requests_,
+        .target_connections = target_connections_,
+        .circuit_open = circuit_open_.load(std::memory_order_relaxed)
     };
 }
 
-void ConnectionPool::health_check_task() {
+bool ConnectionPool::try_release_slot(size_t floor) {
+    size_t current = total_connections_;
+    while (current > floor) {
+        if (total_connections_.compare_exchange_weak(current, current - 1)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void ConnectionPool::cleanup_task() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    
     while (!shutdown_) {
-        std::this_thread::sleep_for(
-            std::chrono::seconds(config_.validation_interval));
+        cleanup_cv_.wait_for(lock, std::chrono::seconds(config_.eviction_interval),
+                             [this] { return shutdown_.load(); });
+        if (shutdown_) break;
+        lock.unlock();
+        
+        size_t floor = std::max(config_.min_connections, target_connections_.load());
+        size_t closed = evict_idle(SIZE_MAX, floor, true);
+        if (closed > 0) {
+            ODBC_LOG_DEBUG("Idle cleanup: closed " << closed << " idle connections");
+        }
+        lock.lock();
+    }
+}
+
+size_t ConnectionPool::evict_idle(size_t count, size_t floor, bool only_expired) {
+    // 从各分片队首（最久未用）开始回收
+    std::vector<Connection::Ptr> expired;
+    for (auto& shard : shards_) {
+        std::lock_guard<std::mutex> shard_lock(shard->mutex);
+        auto& idle = shard->connections;
         
+        while (expired.size() < count && !idle.empty()
+               && (!only_expired || idle.front()->is_idle_timeout(config_.max_idle_time))
+               && try_release_slot(floor)) {
+            expired.push_back(std::move(idle.front()));
+            idle.pop_front();
+            idle_count_--;
+        }
+    }
+    
+    metrics_->evictions.fetch_add(expired.size(), std::memory_order_relaxed);
+    // 在分片锁外断开连接
+    return expired.size();
+}
+
+void ConnectionPool::autoscale_task() {
+    struct Sample {
+        uint64_t borrows;      ///< 本次采样间隔内的借用次数
+        uint64_t wait_us;      ///< 这些借用的等待时间之和
+        double utilization;    ///< 采样时活跃连接占比
+        size_t waiting;        ///< 采样时的等待者数
+    };
+    
+    std::deque<Sample> window;
+    HistogramSnapshot last_wait = metrics_->borrow_wait.snapshot();
+    size_t window_size = std::max<size_t>(1, config_.autoscale_window);
+    size_t step = std::max<size_t>(1, config_.autoscale_max_step);
+    
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (!shutdown_) {
+        cleanup_cv_.wait_for(lock, std::chrono::milliseconds(config_.autoscale_interval_ms),
+                             [this] { return shutdown_.load(); });
         if (shutdown_) break;
+        lock.unlock();
         
-        std::lock_guard<std::mutex> lock(mutex_);
+        // 采样并维护滑动窗口
+        HistogramSnapshot wait = metrics_->borrow_wait.snapshot();
+        size_t total = total_connections_;
+        size_t active = active_count_;
+        Sample sample{wait.count - last_wait.count, wait.sum_us - last_wait.sum_us,
+                      total > 0 ? static_cast<double>(active) / total : 1.0,
+                      waiting_requests_};
+        last_wait = wait;
+        window.push_back(sample);
+        if (window.size() > window_size) {
+            window.pop_front();
+        }
+        
+        uint64_t borrows = 0;
+        uint64_t wait_us = 0;
+        double utilization = 0.0;
+        size_t peak_waiting = 0;
+        for (const auto& s : window) {
+            borrows += s.borrows;
+            wait_us += s.wait_us;
+            utilization += s.utilization;
+            peak_waiting = std::max(peak_waiting, s.waiting);
+        }
+        utilization /= window.size();
+        double mean_wait_ms = borrows > 0 ? wait_us / 1000.0 / borrows : 0.0;
         
-        // 检查空闲连接的健康状态
-        std::queue<std::unique_ptr<Connection>> healthy_connections;
-        size_t invalid_count = 0;
+        // 等待上升时按步长提高目标，窗口内持续空闲时按步长降低目标
+        size_t target = target_connections_;
+        if (sample.waiting > 0 || mean_wait_ms > config_.autoscale_wait_threshold_ms) {
+            target = std::min(config_.max_connections, std::max(target, total) + step);
+        } else if (window.size() == window_size && peak_waiting == 0
+                   && utilization < config_.autoscale_low_utilization) {
+            target = target > config_.min_connections + step ? target - step
+                                                             : config_.min_connections;
+            target = std::max(target, active);
+        }
+        target_connections_ = target;
         
-        while (!idle_connections_.empty()) {
-            auto conn = std::move(idle_connections_.front());
-            idle_connections_.pop();
-            
-            if (conn->is_connected()) {
-                healthy_connections.push(std::move(conn));
-            } else {
-                invalid_count++;
-                total_connections_--;
-            }
+        // 提前建连，与借用时相同由后台建连线程完成
+        lock.lock();
+        for (size_t opened = 0; opened < step && total_connections_ < target && !shutdown_;
+             ++opened) {
+            total_connections_++;
+            opens_pending_++;
+            opener_cv_.notify_one();
         }
+        lock.unlock();
         
-        idle_connections_ = std::move(healthy_connections);
+        if (total_connections_ > target) {
+            size_t closed = evict_idle(step, target, false);
+            if (closed > 0) {
+                ODBC_LOG_DEBUG("Autoscale: closed " << closed << " idle connections, target "
+                               << target);
+            }
+        }
+        lock.lock();
+    }
+}
+
+void ConnectionPool::health_check_task() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    
+    while (!shutdown_) {
+        // 关闭时立即唤醒
+        cleanup_cv_.wait_for(lock, std::chrono::seconds(config_.validation_interval),
+                             [this] { return shutdown_.load(); });
+        if (shutdown_) break;
+        lock.unlock();
         
+        size_t invalid_count = validate_idle();
         if (invalid_count > 0) {
-            std::cout << "Health check: Removed " << invalid_count 
-                      << " invalid connections" << std::endl;
+            ODBC_LOG_INFO("Health check: removed " << invalid_count << " invalid connections");
+        }
+        lock.lock();
+    }
+}
+
+size_t ConnectionPool::validate_idle() {
+    auto round_start = std::chrono::steady_clock::now();
+    auto skip = std::chrono::milliseconds(config_.borrow_validation_skip_ms);
+    size_t batch_size = std::max<size_t>(1, config_.validation_batch);
+    unsigned int timeout = static_cast<unsigned int>(config_.validation_timeout);
+    size_t invalid_count = 0;
+    
+    for (auto& shard : shards_) {
+        while (!shutdown_) {
+            // 每次只取出少量本轮尚未验证的连接，其余连接照常可借
+            std::vector<Connection::Ptr> batch;
+            {
+                std::lock_guard<std::mutex> shard_lock(shard->mutex);
+                auto& idle = shard->connections;
+                for (auto it = idle.begin(); it != idle.end() && batch.size() < batch_size;) {
+                    if ((*it)->last_validated() < round_start
+                        && round_start - (*it)->last_used() >= skip) {
+                        batch.push_back(std::move(*it));
+                        it = idle.erase(it);
+                        idle_count_--;
+                    } else {
+                        ++it;
+                    }
+                }
+            }
+            if (batch.empty()) {
+                break;
+            }
+            
+            // 在锁外验证，失效连接在此断开
+            std::vector<Connection::Ptr> alive;
+            size_t removed = 0;
+            for (auto& conn : batch) {
+                if (conn->validate(timeout)) {
+                    conn->update_last_validated();
+                    alive.push_back(std::move(conn));
+                } else {
+                    removed++;
+                }
+            }
+            batch.clear();
+            if (removed > 0) {
+                total_connections_ -= removed;
+                invalid_count += removed;
+                metrics_->validation_failures.fetch_add(removed, std::memory_order_relaxed);
+            }
+            
+            // 放回队首，保持最久未用的连接在前
+            {
+                std::lock_guard<std::mutex> shard_lock(shard->mutex);
+                for (auto it = alive.rbegin(); it != alive.rend(); ++it) {
+                    shard->connections.push_front(std::move(*it));
+                }
+                idle_count_ += alive.size();
+            }
+            if (waiting_requests_ > 0) {
+                std::lock_guard<std::mutex> lock(mutex_);
+                drain_idle_to_waiters_locked();
+                request_open_locked();
+            }
+            // 空闲的池同样需要补足被移除的连接，否则下次借用才付出建连开销
+            if (removed > 0) {
+                std::lock_guard<std::mutex> lock(mutex_);
+                refill_locked();
+            }
         }
     }
+    return invalid_count;
+}
+
+bool ConnectionPool::validate_on_borrow(Connection& conn) const {
+    if (!borrow_ping_needed(conn)) {
+        return conn.is_connected();
+    }
+    return conn.validate(static_cast<unsigned int>(config_.validation_timeout));
+}
+
+bool ConnectionPool::borrow_ping_needed(const Connection& conn) const {
+    auto idle_for = std::chrono::steady_clock::now() - conn.last_used();
+    return idle_for >= std::chrono::milliseconds(config_.borrow_validation_skip_ms);
 }
 
-} // namespace odbc
\ No newline at end of file
+} // namespace odbc
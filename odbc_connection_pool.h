@@ -2,60 +2,113 @@
 #define __ODBC_CONNECTION_POOL_H__
 
 #include "odbc_wrapper.h"
+#include "odbc_logger.h"
+#include "odbc_metrics.h"
+#include "odbc_result_cache.h"
 #include <memory>
 #include <mutex>
 #include <condition_variable>
 #include <queue>
+#include <deque>
 #include <vector>
 #include <atomic>
 #include <thread>
 #include <chrono>
 #include <unordered_set>
 #include <functional>
+#include <future>
+#include <exception>
 
 namespace odbc {
 
+/**
+ * @brief 借用通道配置，用于区分交互请求与批处理等不同负载
+ */
+struct LaneConfig {
+    size_t reserved = 0;   ///< 为本通道保留的连接数，其他通道不能占用
+    size_t limit = 0;      ///< 本通道最多同时借出的连接数，0为不限制
+    int priority = 0;      ///< 等待者的优先级，越小越先获得连接
+};
+
 /**
  * @brief 连接池配置结构体
  */
 struct ConnectionPoolConfig {
     size_t min_connections = 5;           ///< 最小连接数
     size_t max_connections = 20;          ///< 最大连接数
-    size_t max_idle_time = 300;           ///< 最大空闲时间(秒)
+    size_t max_idle_time = 300;           ///< 最大空闲时间(秒)，超过后回收至min_connections
+    size_t eviction_interval = 30;        ///< 空闲回收检查间隔(秒)
     size_t connection_timeout = 30;       ///< 连接超时时间(秒)
     size_t validation_interval = 60;     ///< 健康检查间隔(秒)
+    size_t validation_timeout = 2;        ///< 验证连接时ping的超时(秒)
+    size_t validation_batch = 4;          ///< 健康检查每次从分片取出验证的连接数
+    size_t borrow_validation_skip_ms = 500; ///< 距上次使用不足此时间的连接借用时不再ping
+    size_t max_concurrent_connects = 2;   ///< 后台同时建连的上限
+    size_t prefill_concurrency = 4;       ///< 启动时并行建立min_connections的线程数
+    size_t prefill_retries = 2;           ///< 预建连接失败后的重试次数
+    size_t prefill_retry_backoff_ms = 200; ///< 预建重试的退避时间(毫秒)，每次翻倍
+    bool wait_for_prefill = true;         ///< 构造函数是否等待预建完成(最多connection_timeout秒)
+    
+    // 熔断：连续建连失败后在一段时间内直接拒绝需要新连接的借用，到期后只放行一次探测
+    size_t circuit_failure_threshold = 5;  ///< 连续建连失败达到此次数时熔断，0为不启用
+    size_t circuit_open_ms = 1000;         ///< 首次熔断时长(毫秒)，探测失败后翻倍，带随机抖动
+    size_t circuit_max_open_ms = 30000;    ///< 熔断时长上限(毫秒)
+    
+    // 借用通道：get_connection的lane参数为下标，为空时所有借用不区分通道
+    // reserved之和不能超过max_connections且须给每个通道留有可借的连接，limit不能小于reserved，否则构造时抛出std::invalid_argument
+    std::vector<LaneConfig> lanes;
+    size_t lane_aging_ms = 200;            ///< 等待每满此时长优先级提升一级，避免低优先级饿死，0为不提升
+    size_t idle_shards = 1;               ///< 空闲连接分片数，大于1时按线程分散借还
     bool test_on_borrow = true;           ///< 借用时测试连接
     bool test_on_return = false;          ///< 归还时测试连接
+    size_t statement_cache_size = 32;     ///< 每个连接缓存的预备语句数，0为不缓存
+    size_t async_threads = 2;             ///< 异步轮询线程数，首次异步调用时启动；不支持异步的驱动另用阻塞执行线程
+    
+    // 自动伸缩：在[min_connections, max_connections]内按等待与利用率调整连接数
+    bool autoscale = false;                     ///< 是否启用自动伸缩
+    size_t autoscale_interval_ms = 1000;        ///< 采样间隔(毫秒)
+    size_t autoscale_window = 10;               ///< 滑动窗口长度(采样次数)
+    size_t autoscale_max_step = 2;              ///< 每次采样最多预建或回收的连接数
+    double autoscale_wait_threshold_ms = 5.0;   ///< 窗口内平均借用等待超过此值时扩容
+    double autoscale_low_utilization = 0.3;     ///< 窗口内平均利用率低于此值且无等待时缩容
+    
+    // 结果缓存：仅对显式调用cached_query的只读查询生效
+    size_t result_cache_bytes = 0;              ///< 缓存容量(字节)，0为不启用
+    size_t result_cache_ttl_ms = 1000;          ///< 默认有效期(毫秒)
+    
+    // 创建物理连接，为空时按connection_config连接数据库；可替换为进程内实现以单独测量连接池开销
+    std::function<Connection::Ptr(const ConnectionConfig&, const Environment::Ptr&)> connection_factory;
+    
+    // 连接建立后执行一次的初始化，如设置会话变量；抛出异常时该连接视为建立失败
+    std::function<void(Connection&)> on_connect;
+    std::vector<std::string> warm_statements;   ///< 建连后预先准备并放入语句缓存的SQL
     
     // 连接字符串或配置
     ConnectionConfig connection_config;
 };
 
+class ConnectionPool;
+
 // RAII连接句柄
+// 句柄是可移动的值类型，只保存连接、所属连接池与借出时间，借还过程不分配内存。
+// 为兼容原先的unique_ptr用法，提供operator->与reset。
 class PoolConnectionHandle {
 public:
-    using Ptr = std::unique_ptr<PoolConnectionHandle>;
-    using ReleaseFunc = std::function<void(Connection::Ptr)>;
+    using Ptr = PoolConnectionHandle;
 
-    PoolConnectionHandle(Connection::Ptr conn, ReleaseFunc release_func)
-        : conn_(std::move(conn)) {
-        release_func_ = std::move(release_func);
-        std::cout << "======PoolConnectionHandle, conn_: " << (conn_ == nullptr) << ", release_func_:" << (release_func_ == nullptr) << std::endl;
+    PoolConnectionHandle() = default;
+    
+    PoolConnectionHandle(Connection::Ptr conn, std::weak_ptr<ConnectionPool> pool,
+                         std::chrono::steady_clock::time_point checkout_time, size_t lane = 0)
+        : conn_(std::move(conn))
+        , pool_(std::move(pool))
+        , checkout_time_(checkout_time)
+        , lane_(lane) {
+        ODBC_LOG_TRACE("PoolConnectionHandle, conn_: " << (conn_ == nullptr));
     }
     
     ~PoolConnectionHandle() {
-        try
-        {
-            std::cout << "~PoolConnectionHandle, conn_: " << (conn_ == nullptr) << ", release_func_:" << (release_func_ == nullptr) << std::endl;
-            if (conn_) {
-                release_func_(std::move(conn_));
-            }
-        }
-        catch(const std::exception& e)
-        {
-            std::cerr << "~PoolConnectionHandle, err: " << e.what() << std::endl;;
-        }
-        
+        reset();
     }
     
     // 禁止拷贝
@@ -65,18 +118,41 @@ public:
     // 允许移动
     PoolConnectionHandle(PoolConnectionHandle&& other) noexcept
         : conn_(std::move(other.conn_))
-        , release_func_(std::move(other.release_func_)) {
-        other.release_func_ = nullptr;
+        , pool_(std::move(other.pool_))
+        , checkout_time_(other.checkout_time_)
+        , lane_(other.lane_) {
     }
     
     PoolConnectionHandle& operator=(PoolConnectionHandle&& other) noexcept {
         if (this != &other) {
+            reset();
             conn_ = std::move(other.conn_);
-            release_func_ = std::move(other.release_func_);
-            other.release_func_ = nullptr;
+            pool_ = std::move(other.pool_);
+            checkout_time_ = other.checkout_time_;
+            lane_ = other.lane_;
         }
         return *this;
     }
+    
+    PoolConnectionHandle* operator->() { return this; }
+    const PoolConnectionHandle* operator->() const { return this; }
+    
+    /**
+     * @brief 提前归还连接，连接池已销毁时直接关闭连接
+     */
+    void reset() noexcept {
+        if (!conn_) {
+            return;
+        }
+        try {
+            ODBC_LOG_TRACE("~PoolConnectionHandle, conn_: " << (conn_ == nullptr));
+            release();
+        } catch (const std::exception& e) {
+            ODBC_LOG_ERROR("~PoolConnectionHandle, err: " << e.what());
+        }
+        conn_.reset();
+        pool_.reset();
+    }
 
     bool is_connected() {
         if (!conn_) {
@@ -99,11 +175,69 @@ public:
         return conn_->query(sql);
     }
     
+    std::vector<StatementResult> query_multi(const std::string& script) {
+        if (!conn_) {
+            throw std::runtime_error("Connection handle is invalid");
+        }
+        return conn_->query_multi(script);
+    }
+    
+    std::vector<StatementResult> query_multi(const std::vector<std::string>& statements) {
+        if (!conn_) {
+            throw std::runtime_error("Connection handle is invalid");
+        }
+        return conn_->query_multi(statements);
+    }
+    
+    template<typename T>
+    std::vector<T> query_as(const std::string& sql) {
+        if (!conn_) {
+            throw std::runtime_error("Connection handle is invalid");
+        }
+        return conn_->query_as<T>(sql);
+    }
+    
+    // 预备语句随连接缓存，必须在句柄归还前释放
+    Connection::PreparedStatementPtr prepare(const std::string& sql) {
+        if (!conn_) {
+            throw std::runtime_error("Connection handle is invalid");
+        }
+        return conn_->prepare(sql);
+    }
+    
+    Connection::StatementCacheStats statement_cache_stats() const {
+        if (!conn_) {
+            throw std::runtime_error("Connection handle is invalid");
+        }
+        return conn_->statement_cache_stats();
+    }
+    
+    // 开始事务，作用域结束前未提交则回滚；事务对象必须在句柄归还前结束
+    Connection::Transaction transaction() {
+        if (!conn_) {
+            throw std::runtime_error("Connection handle is invalid");
+        }
+        return conn_->transaction();
+    }
+    
+    // 游标必须在句柄归还前关闭
+    Cursor open_cursor(const std::string& sql, size_t batch_size = 0) {
+        if (!conn_) {
+            throw std::runtime_error("Connection handle is invalid");
+        }
+        return conn_->open_cursor(sql, batch_size);
+    }
+    
     explicit operator bool() const { return conn_ != nullptr; }
     
 private:
+    // 定义在ConnectionPool之后
+    void release();
+    
     Connection::Ptr conn_;
-    ReleaseFunc release_func_;
+    std::weak_ptr<ConnectionPool> pool_;
+    std::chrono::steady_clock::time_point checkout_time_;
+    size_t lane_ = 0;
 };
 
 /**
@@ -121,10 +255,94 @@ public:
     
     /**
      * @brief 获取连接（支持超时）
+     *
+     * 配置了lanes时按lane借用：本通道达到limit或剩余连接都被其他通道保留时排队，
+     * 等待者按通道优先级(随等待时间提升)获得连接。
      */
     PoolConnectionHandle::Ptr get_connection(
+        std::chrono::milliseconds timeout = std::chrono::milliseconds(5000),
+        size_t lane = 0);
+    
+    using QueryCallback = std::function<void(std::exception_ptr error, ResultSet result)>;
+    using ExecuteCallback = std::function<void(std::exception_ptr error, size_t affected_rows)>;
+    
+    /**
+     * @brief 异步查询
+     *
+     * 借连接、执行与归还都不阻塞调用线程：没有空闲连接时登记为等待者，连接移交后由异步执行线程
+     * 以ODBC轮询模式推进执行。驱动不支持SQL_ATTR_ASYNC_ENABLE时(如MariaDB/MySQL)交给阻塞执行线程
+     * 同步执行，阻塞执行线程按需增加，最多max_connections个。借用时需要ping的校验与查询结果的取数
+     * 同样在阻塞执行线程中进行，异步执行线程只负责轮询与移交。
+     * 回调在异步或阻塞执行线程中调用，失败时error非空。
+     */
+    void async_query(const std::string& sql, QueryCallback callback,
+                     std::chrono::milliseconds timeout = std::chrono::milliseconds(5000));
+    std::future<ResultSet> async_query(
+        const std::string& sql,
+        std::chrono::milliseconds timeout = std::chrono::milliseconds(5000));
+    
+    /**
+     * @brief 异步执行（无结果集），返回影响的行数
+     */
+    void async_execute(const std::string& sql, ExecuteCallback callback,
+                       std::chrono::milliseconds timeout = std::chrono::milliseconds(5000));
+    std::future<size_t> async_execute(
+        const std::string& sql,
         std::chrono::milliseconds timeout = std::chrono::milliseconds(5000));
     
+    /**
+     * @brief 带缓存的查询，params按顺序绑定到SQL中的?
+     *
+     * 以SQL文本和参数为键，命中时不借用连接；同一键的并发未命中只执行一次查询。
+     * 未启用缓存时每次都执行查询。仅用于幂等的SELECT，写入后需调用invalidate_cache。
+     */
+    template<typename... Args>
+    std::shared_ptr<const ResultSet> cached_query(const std::string& sql,
+                                                  const QueryCacheOptions& options = QueryCacheOptions(),
+                                                  const Args&... params) {
+        auto loader = [&]() { return load_query(sql, params...); };
+        if (!result_cache_) {
+            return std::make_shared<const ResultSet>(loader());
+        }
+        auto ttl = options.ttl.count() > 0 ? options.ttl
+                                           : std::chrono::milliseconds(config_.result_cache_ttl_ms);
+        return result_cache_->get_or_load(cache_key::build(sql, params...), ttl, options.tags, loader);
+    }
+    
+    /**
+     * @brief 使带有该标签的缓存结果失效
+     */
+    void invalidate_cache(const std::string& tag) {
+        if (result_cache_) {
+            result_cache_->invalidate(tag);
+        }
+    }
+    
+    /**
+     * @brief 清空结果缓存
+     */
+    void clear_cache() {
+        if (result_cache_) {
+            result_cache_->clear();
+        }
+    }
+    
+    ResultCacheStats cache_stats() const {
+        return result_cache_ ? result_cache_->stats() : ResultCacheStats();
+    }
+    
+    /**
+     * @brief 等待启动预建完成，超时返回false
+     */
+    bool wait_ready(std::chrono::milliseconds timeout) const {
+        return ready_.wait_for(timeout) == std::future_status::ready;
+    }
+    
+    /**
+     * @brief 启动预建完成(含失败与关闭)时就绪
+     */
+    std::shared_future<void> ready() const { return ready_; }
+    
     /**
      * @brief 获取连接池状态
      */
@@ -133,10 +351,29 @@ public:
         size_t idle_connections;
         size_t active_connections;
         size_t waiting_requests;
+        size_t target_connections;  ///< 自动伸缩的目标连接数，未启用时为min_connections
+        bool circuit_open;          ///< 是否处于熔断中
     };
     
     PoolStatus get_status() const;
     
+    /**
+     * @brief 获取指定通道借出的连接数，未配置通道或下标越界时为0
+     */
+    size_t lane_active(size_t lane) const {
+        return lane < lane_active_.size() ? lane_active_[lane].load(std::memory_order_relaxed) : 0;
+    }
+    
+    /**
+     * @brief 获取延迟直方图与计数器快照
+     */
+    PoolMetricsSnapshot get_metrics() const { return metrics_->snapshot(); }
+    
+    /**
+     * @brief 设置进程内所有连接池同时握手的连接数上限，0为不限制
+     */
+    static void set_global_connect_limit(size_t limit);
+    
     /**
      * @brief 关闭连接池
      */
@@ -144,7 +381,7 @@ public:
     /**
      * @brief 将连接归还到池中
      */
-    void return_connection(std::unique_ptr<Connection> conn);
+    void return_connection(std::unique_ptr<Connection> conn, size_t lane = 0);
     /**
      * @brief 是否已关闭
      */
@@ -158,40 +395,347 @@ private:
      */
     std::unique_ptr<Connection> create_connection();
     
+    /**
+     * @brief 启动预建线程函数，各线程分摊min_connections个连接并各自重试
+     */
+    void prefill_task();
+    
     /**
      * @brief 健康检查线程函数
      */
     void health_check_task();
     
     /**
-     * @brief 从池中获取空闲连接（内部使用）
+     * @brief 分批取出空闲连接在锁外验证，返回移除的失效连接数
+     */
+    size_t validate_idle();
+    
+    /**
+     * @brief test_on_borrow的验证，最近使用过的连接跳过ping
+     */
+    bool validate_on_borrow(Connection& conn) const;
+    
+    /**
+     * @brief test_on_borrow是否需要ping，否则只检查连接状态
+     */
+    bool borrow_ping_needed(const Connection& conn) const;
+    
+    /**
+     * @brief 空闲回收线程函数，关闭超过max_idle_time的连接
+     */
+    void cleanup_task();
+    
+    /**
+     * @brief 总连接数大于floor时减少一个，返回是否成功
+     */
+    bool try_release_slot(size_t floor);
+    
+    /**
+     * @brief 自动伸缩线程函数
+     */
+    void autoscale_task();
+    
+    /**
+     * @brief 从各分片队首关闭最多count个空闲连接，总数不低于floor，返回关闭数
+     */
+    size_t evict_idle(size_t count, size_t floor, bool only_expired);
+    
+    /**
+     * @brief 等待连接的借用者，按到达顺序排队
+     *
+     * 归还的连接直接移交给队首等待者，不经过空闲队列。
+     * Waiter对象位于等待线程的栈上，所有字段均受mutex_保护。
+     */
+    struct AsyncTask;
+    
+    struct Waiter {
+        std::condition_variable cv;
+        Connection::Ptr conn;       ///< 被移交的连接
+        
+        // 异步等待者位于堆上，连接移交后直接交给异步执行线程
+        std::unique_ptr<AsyncTask> async;
+        std::chrono::steady_clock::time_point deadline;
+        
+        size_t lane = 0;                                ///< 借用通道
+        std::chrono::steady_clock::time_point since;    ///< 开始等待的时间，用于优先级提升
+    };
+    
+    /**
+     * @brief 一次异步执行，依次经历等待连接、执行中、完成
+     */
+    struct AsyncTask {
+        std::string sql;
+        QueryCallback on_query;       ///< 与on_execute二选一
+        ExecuteCallback on_execute;
+        std::chrono::steady_clock::time_point submit_time;
+        std::chrono::steady_clock::time_point deadline;
+        std::chrono::steady_clock::time_point checkout_time;
+        Connection::Ptr conn;
+        std::unique_ptr<Connection::AsyncStatement> stmt;
+        bool executed = false;        ///< 语句已执行完成，只剩取结果
+        size_t lane = 0;              ///< 异步借用使用默认通道
+    };
+    
+    /**
+     * @brief 空闲连接分片，每个分片有独立的锁
+     *
+     * 借还优先使用本线程对应的分片，本分片为空时从其他分片窃取。
+     * 分片按后进先出使用，队首始终是最久未用的连接，便于回收。
+     */
+    struct alignas(64) IdleShard {
+        std::mutex mutex;
+        std::deque<Connection::Ptr> connections;
+    };
+    
+    /**
+     * @brief 排队等待连接移交（调用方需持有mutex_）
+     */
+    Connection::Ptr acquire_locked(std::unique_lock<std::mutex>& lock,
+                                   std::chrono::steady_clock::time_point deadline,
+                                   size_t lane);
+    
+    /**
+     * @brief lane可以再借出一个连接时占用名额并返回true，未配置通道时总是成功
+     */
+    bool lane_admit(size_t lane);
+    
+    /**
+     * @brief 不占用名额，仅判断lane是否可以再借出
+     */
+    bool lane_admissible(size_t lane) const;
+    
+    void lane_release(size_t lane) {
+        if (!lane_active_.empty()) {
+            lane_active_[lane]--;
+        }
+    }
+    
+    /**
+     * @brief 选出下一个获得连接的等待者并占用其通道名额，没有可服务的等待者时返回end
+     */
+    std::deque<Waiter*>::iterator select_waiter_locked();
+    
+    /**
+     * @brief 从空闲分片取出有效连接，本分片为空时窃取其他分片
+     */
+    Connection::Ptr borrow_from_pool();
+    
+    /**
+     * @brief 将连接放入指定空闲分片
+     */
+    void push_idle(Connection::Ptr conn, size_t shard_index);
+    
+    /**
+     * @brief 当前线程对应的分片下标
+     */
+    size_t local_shard() const;
+    
+    /**
+     * @brief 将分片中的空闲连接依次移交给等待者（调用方需持有mutex_）
+     */
+    void drain_idle_to_waiters_locked();
+    
+    /**
+     * @brief 将连接交给队首等待者，没有等待者时返回false（调用方需持有mutex_）
+     */
+    bool hand_off_locked(Connection::Ptr& conn);
+    
+    /**
+     * @brief 将可用连接移交给等待者或放回空闲队列（调用方需持有mutex_）
+     */
+    void publish_locked(Connection::Ptr conn);
+    
+    /**
+     * @brief 等待者多于建立中的连接时，占用连接数并请求后台建连（调用方需持有mutex_）
+     */
+    void request_open_locked();
+    
+    /**
+     * @brief 连接数低于min_connections或自动伸缩目标时请求后台建连补足，熔断期间不补（调用方需持有mutex_）
+     */
+    void refill_locked();
+    
+    /**
+     * @brief 后台建连线程函数，在锁外完成握手后发布连接
+     */
+    void opener_task();
+    
+    enum class CircuitState {
+        Closed,     ///< 正常建连
+        Open,       ///< 熔断中，到期前不建连
+        HalfOpen    ///< 已放行一次探测，结果返回前不再建连
+    };
+    
+    /**
+     * @brief 熔断期间拒绝需要新连接的借用（调用方需持有mutex_）
+     */
+    bool circuit_rejecting_locked(std::chrono::steady_clock::time_point now) const {
+        return circuit_state_ == CircuitState::Open && now < circuit_open_until_;
+    }
+    
+    /**
+     * @brief 熔断期间等待者多于借出的连接时，归还的连接不够分配，多出的等待者应当失败（调用方需持有mutex_）
+     */
+    bool circuit_rejects_waiter_locked(std::chrono::steady_clock::time_point now) const {
+        return circuit_rejecting_locked(now) && waiting_requests_ > active_count_;
+    }
+    
+    /**
+     * @brief 唤醒同步等待者重新检查熔断（调用方需持有mutex_）
+     */
+    void wake_sync_waiters_locked();
+    
+    /**
+     * @brief 是否允许发起建连，熔断到期时转为探测（调用方需持有mutex_）
+     */
+    bool connect_allowed_locked();
+    
+    /**
+     * @brief 记录建连结果，连续失败达到阈值或探测失败时熔断（调用方需持有mutex_）
+     */
+    void record_connect_locked(bool success);
+    
+    /**
+     * @brief 为异步任务借用连接，无空闲连接时登记异步等待者
+     */
+    void submit_async(std::unique_ptr<AsyncTask> task);
+    
+    /**
+     * @brief 已获得连接的异步任务交给异步执行线程
+     */
+    void enqueue_async(std::unique_ptr<AsyncTask> task);
+    
+    /**
+     * @brief 异步执行线程函数，轮询本线程的执行中语句
+     */
+    void async_worker();
+    
+    /**
+     * @brief 借用校验并开始执行，校验失败时重新提交、出错时以失败结束并返回false
      */
-    PoolConnectionHandle::Ptr borrow_from_pool();
+    bool start_async(std::unique_ptr<AsyncTask>& task);
+    
+    /**
+     * @brief 会阻塞的步骤(借用ping、同步执行、取结果)交给阻塞执行线程，没有空闲线程且未达上限时新建
+     */
+    void enqueue_blocking(std::unique_ptr<AsyncTask> task);
+    
+    /**
+     * @brief 阻塞执行线程函数，逐个完成任务剩余的步骤
+     */
+    void blocking_worker();
+    
+    /**
+     * @brief 取结果、归还连接并调用回调，error非空时直接以失败结束
+     */
+    void complete_async(AsyncTask& task, std::exception_ptr error);
+    
+    /**
+     * @brief 使超过截止时间的异步等待者失败
+     */
+    void expire_async_waiters();
+    
+    /**
+     * @brief 借连接执行查询，有参数时通过预备语句绑定
+     */
+    template<typename... Args>
+    ResultSet load_query(const std::string& sql, const Args&... params) {
+        auto handle = get_connection();
+        if constexpr (sizeof...(Args) == 0) {
+            return handle->query(sql);
+        } else {
+            auto stmt = handle->prepare(sql);
+            SQLUSMALLINT index = 0;
+            int expand[] = {0, (stmt->bind_param(++index, params), 0)...};
+            (void)expand;
+            return stmt->execute_query();
+        }
+    }
+    
+    /**
+     * @brief 将连接包装为RAII句柄
+     */
+    PoolConnectionHandle::Ptr make_handle(Connection::Ptr conn, size_t lane = 0);
     
     // 连接池配置
     ConnectionPoolConfig config_;
     
+    // 所有池内连接共享的ODBC环境
+    Environment::Ptr env_;
+    
+    // 指标，语句指标部分由池内连接共享，连接可能比连接池存活更久
+    std::shared_ptr<PoolMetrics> metrics_;
+    
+    // 结果缓存，未启用时为空
+    std::unique_ptr<ResultCache> result_cache_;
+    
     // 连接存储
-    std::queue<Connection::Ptr> idle_connections_;
-    std::unordered_set<Connection::Ptr> active_connections_;
+    std::vector<std::unique_ptr<IdleShard>> shards_;
+    std::deque<Waiter*> waiters_;          ///< FIFO等待队列（受mutex_保护）
     
     // 同步原语
     mutable std::mutex mutex_;
-    std::condition_variable condition_;
     
     // 状态变量
     std::atomic<size_t> total_connections_{0};
+    std::atomic<size_t> idle_count_{0};
+    std::atomic<size_t> active_count_{0};
     std::atomic<size_t> waiting_requests_{0};
     std::atomic<bool> shutdown_{false};
+    std::atomic<size_t> target_connections_{0};
+    std::vector<std::atomic<size_t>> lane_active_;   ///< 各通道借出的连接数，未配置通道时为空
+    
+    // 后台建连状态（受mutex_保护）
+    std::condition_variable opener_cv_;
+    std::condition_variable cleanup_cv_;   ///< 用于关闭时唤醒回收线程
+    size_t opens_pending_ = 0;             ///< 已请求尚未开始的建连
+    size_t opens_in_flight_ = 0;           ///< 正在握手的建连
+    
+    // 熔断状态（受mutex_保护）
+    CircuitState circuit_state_ = CircuitState::Closed;
+    size_t consecutive_connect_failures_ = 0;
+    std::chrono::milliseconds circuit_backoff_{0};
+    std::chrono::steady_clock::time_point circuit_open_until_;
+    std::atomic<bool> circuit_open_{false};    ///< circuit_state_不为Closed，供get_status无锁读取
+    
+    // 异步执行状态（受async_mutex_保护），加锁顺序为mutex_先于async_mutex_
+    std::mutex async_mutex_;
+    std::condition_variable async_cv_;
+    std::deque<std::unique_ptr<AsyncTask>> async_ready_;
+    std::vector<std::thread> async_threads_;
+    bool async_stop_ = false;
+    std::condition_variable blocking_cv_;
+    std::deque<std::unique_ptr<AsyncTask>> blocking_ready_;
+    std::vector<std::thread> blocking_threads_;
+    size_t blocking_idle_ = 0;      ///< 正在等待任务的阻塞执行线程数
+    
+    // 启动预建状态
+    std::atomic<size_t> prefill_next_{0};      ///< 下一个待预建连接的序号
+    std::atomic<size_t> prefill_workers_{0};   ///< 尚未结束的预建线程数
+    std::promise<void> ready_promise_;
+    std::shared_future<void> ready_;
     
     // 后台线程
+    std::vector<std::thread> prefill_threads_;
+    std::vector<std::thread> opener_threads_;
     std::thread cleanup_thread_;
     std::thread health_check_thread_;
+    std::thread autoscale_thread_;
     
-    // 友元声明，允许PooledConnection访问return_connection
-    // friend class Connection;
+    // 句柄归还时记录持有时长
+    friend class PoolConnectionHandle;
 };
 
+inline void PoolConnectionHandle::release() {
+    if (auto pool = pool_.lock()) {
+        pool->metrics_->hold_time.record(std::chrono::steady_clock::now() - checkout_time_);
+        pool->return_connection(std::move(conn_), lane_);
+    } else {
+        // 连接池已被销毁，连接随句柄关闭
+        ODBC_LOG_DEBUG("connection pool already released");
+    }
+}
+
 /**
  * @brief 连接池智能指针的删除器
  */
@@ -0,0 +1,146 @@
+#ifndef __ODBC_LOGGER_H__
+#define __ODBC_LOGGER_H__
+
+#include <atomic>
+#include <cstdio>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+
+/**
+ * @brief 编译期保留的最低日志级别，低于此级别的ODBC_LOG_*调用不会生成代码
+ *
+ * 0=Trace 1=Debug 2=Info 3=Warn 4=Error，默认去掉Trace
+ */
+#ifndef ODBC_LOG_COMPILED_LEVEL
+#define ODBC_LOG_COMPILED_LEVEL 1
+#endif
+
+namespace odbc {
+
+enum class LogLevel {
+    Trace = 0,
+    Debug = 1,
+    Info = 2,
+    Warn = 3,
+    Error = 4,
+    Off = 5
+};
+
+inline const char* to_string(LogLevel level) {
+    switch (level) {
+        case LogLevel::Trace: return "TRACE";
+        case LogLevel::Debug: return "DEBUG";
+        case LogLevel::Info: return "INFO";
+        case LogLevel::Warn: return "WARN";
+        case LogLevel::Error: return "ERROR";
+        default: return "OFF";
+    }
+}
+
+/**
+ * @brief 日志钩子，默认不输出
+ *
+ * 通过set_sink安装输出函数并设置运行期级别；未安装时每条日志只需一次relaxed原子读。
+ */
+class Logger {
+public:
+    using Sink = std::function<void(LogLevel level, const char* file, int line,
+                                    const std::string& message)>;
+
+    /**
+     * @brief 安装日志输出，sink为空时关闭日志
+     */
+    static void set_sink(Sink sink, LogLevel level = LogLevel::Info) {
+        std::shared_ptr<const Sink> next = sink ? std::make_shared<const Sink>(std::move(sink))
+                                                : nullptr;
+        std::lock_guard<std::mutex> lock(state().mutex);
+        state().level.store(next ? level : LogLevel::Off, std::memory_order_release);
+        state().sink = std::move(next);
+    }
+
+    static void set_level(LogLevel level) {
+        std::lock_guard<std::mutex> lock(state().mutex);
+        if (state().sink) {
+            state().level.store(level, std::memory_order_release);
+        }
+    }
+
+    static bool enabled(LogLevel level) {
+        return level >= state().level.load(std::memory_order_relaxed);
+    }
+
+    static void write(LogLevel level, const char* file, int line, const std::string& message) {
+        std::shared_ptr<const Sink> sink;
+        {
+            std::lock_guard<std::mutex> lock(state().mutex);
+            sink = state().sink;
+        }
+        if (sink) {
+            (*sink)(level, file, line, message);
+        }
+    }
+
+    /**
+     * @brief 输出到标准错误的简单实现
+     */
+    static Sink stderr_sink() {
+        return [](LogLevel level, const char* file, int line, const std::string& message) {
+            std::fprintf(stderr, "[%s] %s:%d %s\n", to_string(level), file, line, message.c_str());
+        };
+    }
+
+private:
+    struct State {
+        std::mutex mutex;
+        std::shared_ptr<const Sink> sink;
+        std::atomic<LogLevel> level{LogLevel::Off};
+    };
+
+    static State& state() {
+        static State instance;
+        return instance;
+    }
+};
+
+} // namespace odbc
+
+// 仅在级别开启时才格式化消息
+#define ODBC_LOG(level, expr)                                                   \
+    do {                                                                        \
+        if (::odbc::Logger::enabled(level)) {                                   \
+            std::ostringstream odbc_log_oss_;                                   \
+            odbc_log_oss_ << expr;                                              \
+            ::odbc::Logger::write(level, __FILE__, __LINE__, odbc_log_oss_.str()); \
+        }                                                                       \
+    } while (0)
+
+#if ODBC_LOG_COMPILED_LEVEL <= 0
+#define ODBC_LOG_TRACE(expr) ODBC_LOG(::odbc::LogLevel::Trace, expr)
+#else
+#define ODBC_LOG_TRACE(expr) do {} while (0)
+#endif
+
+#if ODBC_LOG_COMPILED_LEVEL <= 1
+#define ODBC_LOG_DEBUG(expr) ODBC_LOG(::odbc::LogLevel::Debug, expr)
+#else
+#define ODBC_LOG_DEBUG(expr) do {} while (0)
+#endif
+
+#if ODBC_LOG_COMPILED_LEVEL <= 2
+#define ODBC_LOG_INFO(expr) ODBC_LOG(::odbc::LogLevel::Info, expr)
+#else
+#define ODBC_LOG_INFO(expr) do {} while (0)
+#endif
+
+#if ODBC_LOG_COMPILED_LEVEL <= 3
+#define ODBC_LOG_WARN(expr) ODBC_LOG(::odbc::LogLevel::Warn, expr)
+#else
+#define ODBC_LOG_WARN(expr) do {} while (0)
+#endif
+
+#define ODBC_LOG_ERROR(expr) ODBC_LOG(::odbc::LogLevel::Error, expr)
+
+#endif // __ODBC_LOGGER_H__
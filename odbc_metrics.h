@@ -0,0 +1,220 @@
+#ifndef __ODBC_METRICS_H__
+#define __ODBC_METRICS_H__
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <sstream>
+#include <string>
+
+namespace odbc {
+
+/**
+ * @brief 直方图某一时刻的拷贝
+ */
+struct HistogramSnapshot {
+    static constexpr size_t kBuckets = 32;
+
+    std::array<uint64_t, kBuckets> buckets{};  ///< 各桶计数，第i桶上界为2^i微秒
+    uint64_t count = 0;
+    uint64_t sum_us = 0;
+    uint64_t max_us = 0;
+
+    /**
+     * @brief 第i桶的上界(微秒)，最后一桶无上界
+     */
+    static uint64_t bucket_upper_bound(size_t i) { return uint64_t(1) << i; }
+
+    double mean_us() const { return count ? static_cast<double>(sum_us) / count : 0.0; }
+
+    /**
+     * @brief 估算分位数(0-1)，返回所在桶的上界，精度为2倍
+     */
+    uint64_t percentile_us(double q) const {
+        if (count == 0) {
+            return 0;
+        }
+        uint64_t target = static_cast<uint64_t>(q * count);
+        if (target >= count) {
+            target = count - 1;
+        }
+        uint64_t seen = 0;
+        for (size_t i = 0; i < kBuckets; ++i) {
+            seen += buckets[i];
+            if (seen > target) {
+                return i + 1 == kBuckets ? max_us : std::min(bucket_upper_bound(i), max_us);
+            }
+        }
+        return max_us;
+    }
+};
+
+/**
+ * @brief 无锁延迟直方图，按2的幂分桶(微秒)
+ *
+ * 记录一次只需几次relaxed原子操作，快照时各字段分别读取，并发写入时允许轻微偏差。
+ */
+class LatencyHistogram {
+public:
+    static constexpr size_t kBuckets = HistogramSnapshot::kBuckets;
+
+    void record(std::chrono::steady_clock::duration elapsed) {
+        auto us = std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count();
+        record_us(us > 0 ? static_cast<uint64_t>(us) : 0);
+    }
+
+    void record_us(uint64_t us) {
+        buckets_[bucket_index(us)].fetch_add(1, std::memory_order_relaxed);
+        sum_us_.fetch_add(us, std::memory_order_relaxed);
+        uint64_t current = max_us_.load(std::memory_order_relaxed);
+        while (us > current
+               && !max_us_.compare_exchange_weak(current, us, std::memory_order_relaxed)) {
+        }
+    }
+
+    HistogramSnapshot snapshot() const {
+        HistogramSnapshot snap;
+        for (size_t i = 0; i < kBuckets; ++i) {
+            snap.buckets[i] = buckets_[i].load(std::memory_order_relaxed);
+            snap.count += snap.buckets[i];
+        }
+        snap.sum_us = sum_us_.load(std::memory_order_relaxed);
+        snap.max_us = max_us_.load(std::memory_order_relaxed);
+        return snap;
+    }
+
+private:
+    // 小于2^i微秒的值落入第i桶
+    static size_t bucket_index(uint64_t us) {
+        size_t index = us == 0 ? 0 : 64 - __builtin_clzll(us);
+        return index < kBuckets ? index : kBuckets - 1;
+    }
+
+    std::array<std::atomic<uint64_t>, kBuckets> buckets_{};
+    std::atomic<uint64_t> sum_us_{0};
+    std::atomic<uint64_t> max_us_{0};
+};
+
+/**
+ * @brief 作用域计时，析构时记录到直方图，histogram为空时不计时
+ */
+class ScopedLatency {
+public:
+    explicit ScopedLatency(LatencyHistogram* histogram)
+        : histogram_(histogram) {
+        if (histogram_) {
+            start_ = std::chrono::steady_clock::now();
+        }
+    }
+
+    ~ScopedLatency() {
+        if (histogram_) {
+            histogram_->record(std::chrono::steady_clock::now() - start_);
+        }
+    }
+
+    ScopedLatency(const ScopedLatency&) = delete;
+    ScopedLatency& operator=(const ScopedLatency&) = delete;
+
+private:
+    LatencyHistogram* histogram_;
+    std::chrono::steady_clock::time_point start_;
+};
+
+/**
+ * @brief 语句级指标，由连接在执行和取数时记录
+ */
+struct StatementMetrics {
+    LatencyHistogram execute_time;   ///< SQLExecDirect/SQLExecute耗时
+    LatencyHistogram fetch_time;     ///< 结果集取数耗时
+};
+
+/**
+ * @brief 连接池指标快照
+ */
+struct PoolMetricsSnapshot {
+    HistogramSnapshot borrow_wait;
+    HistogramSnapshot connect_time;
+    HistogramSnapshot hold_time;
+    HistogramSnapshot execute_time;
+    HistogramSnapshot fetch_time;
+    uint64_t timeouts = 0;
+    uint64_t connect_failures = 0;
+    uint64_t evictions = 0;
+    uint64_t validation_failures = 0;
+    uint64_t circuit_rejections = 0;
+
+    /**
+     * @brief 按Prometheus文本格式输出，时间单位为秒
+     */
+    std::string to_prometheus(const std::string& prefix = "odbc_pool") const {
+        std::ostringstream oss;
+        write_histogram(oss, prefix + "_borrow_wait_seconds", borrow_wait);
+        write_histogram(oss, prefix + "_connect_seconds", connect_time);
+        write_histogram(oss, prefix + "_hold_seconds", hold_time);
+        write_histogram(oss, prefix + "_execute_seconds", execute_time);
+        write_histogram(oss, prefix + "_fetch_seconds", fetch_time);
+        write_counter(oss, prefix + "_timeouts_total", timeouts);
+        write_counter(oss, prefix + "_connect_failures_total", connect_failures);
+        write_counter(oss, prefix + "_evictions_total", evictions);
+        write_counter(oss, prefix + "_validation_failures_total", validation_failures);
+        write_counter(oss, prefix + "_circuit_rejections_total", circuit_rejections);
+        return oss.str();
+    }
+
+private:
+    static void write_histogram(std::ostringstream& oss, const std::string& name,
+                                const HistogramSnapshot& h) {
+        oss << "# TYPE " << name << " histogram\n";
+        uint64_t cumulative = 0;
+        for (size_t i = 0; i + 1 < HistogramSnapshot::kBuckets; ++i) {
+            cumulative += h.buckets[i];
+            oss << name << "_bucket{le=\"" << HistogramSnapshot::bucket_upper_bound(i) / 1e6
+                << "\"} " << cumulative << "\n";
+        }
+        oss << name << "_bucket{le=\"+Inf\"} " << h.count << "\n";
+        oss << name << "_sum " << h.sum_us / 1e6 << "\n";
+        oss << name << "_count " << h.count << "\n";
+    }
+
+    static void write_counter(std::ostringstream& oss, const std::string& name, uint64_t value) {
+        oss << "# TYPE " << name << " counter\n" << name << " " << value << "\n";
+    }
+};
+
+/**
+ * @brief 连接池指标
+ */
+struct PoolMetrics {
+    LatencyHistogram borrow_wait;    ///< get_connection等待耗时
+    LatencyHistogram connect_time;   ///< 建立物理连接耗时
+    LatencyHistogram hold_time;      ///< 连接借出到归还的时长
+    StatementMetrics statements;     ///< 池内所有连接共享的语句指标
+
+    std::atomic<uint64_t> timeouts{0};
+    std::atomic<uint64_t> connect_failures{0};
+    std::atomic<uint64_t> evictions{0};
+    std::atomic<uint64_t> validation_failures{0};
+    std::atomic<uint64_t> circuit_rejections{0};   ///< 熔断期间被直接拒绝的借用
+
+    PoolMetricsSnapshot snapshot() const {
+        PoolMetricsSnapshot snap;
+        snap.borrow_wait = borrow_wait.snapshot();
+        snap.connect_time = connect_time.snapshot();
+        snap.hold_time = hold_time.snapshot();
+        snap.execute_time = statements.execute_time.snapshot();
+        snap.fetch_time = statements.fetch_time.snapshot();
+        snap.timeouts = timeouts.load(std::memory_order_relaxed);
+        snap.connect_failures = connect_failures.load(std::memory_order_relaxed);
+        snap.evictions = evictions.load(std::memory_order_relaxed);
+        snap.validation_failures = validation_failures.load(std::memory_order_relaxed);
+        snap.circuit_rejections = circuit_rejections.load(std::memory_order_relaxed);
+        return snap;
+    }
+};
+
+} // namespace odbc
+
+#endif // __ODBC_METRICS_H__
@@ -0,0 +1,196 @@
+#include "odbc_pool_router.h"
+#include <algorithm>
+#include <stdexcept>
+
+namespace odbc {
+
+PoolRouter::PoolRouter(const PoolRouterConfig& config)
+    : config_(config) {
+
+    auto add_endpoint = [this](const ConnectionPoolConfig& pool_config) {
+        std::unique_ptr<Endpoint> endpoint(new Endpoint());
+        endpoint->pool = std::make_shared<ConnectionPool>(pool_config);
+        endpoint->max_connections = std::max<size_t>(1, pool_config.max_connections);
+        endpoints_.push_back(std::move(endpoint));
+    };
+
+    add_endpoint(config_.primary);
+    for (const auto& replica : config_.replicas) {
+        add_endpoint(replica);
+    }
+
+    ODBC_LOG_INFO("PoolRouter init, replicas: " << config_.replicas.size());
+}
+
+PoolRouter::~PoolRouter() {
+    shutdown();
+}
+
+PoolConnectionHandle::Ptr PoolRouter::get_connection(
+    AccessMode mode, std::chrono::milliseconds timeout) {
+
+    Endpoint& primary_endpoint = *endpoints_[0];
+    if (mode == AccessMode::Write || endpoints_.size() == 1) {
+        return borrow(primary_endpoint, timeout);
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    auto deadline = start + timeout;
+
+    auto remaining = [&deadline] {
+        return std::chrono::duration_cast<std::chrono::milliseconds>(
+            deadline - std::chrono::steady_clock::now());
+    };
+    auto try_borrow = [&](Endpoint& endpoint) -> PoolConnectionHandle::Ptr {
+        try {
+            return borrow(endpoint, std::min(remaining(),
+                                             std::chrono::milliseconds(config_.replica_timeout_ms)));
+        } catch (const std::exception& e) {
+            ODBC_LOG_WARN("Replica borrow failed, trying next endpoint: " << e.what());
+            return PoolConnectionHandle::Ptr();
+        }
+    };
+
+    // 常见情况只选出最优从库，不分配内存；借用失败后才排序其余从库依次尝试
+    Endpoint* best = best_replica(start);
+    if (best && remaining().count() > 0) {
+        if (auto handle = try_borrow(*best)) {
+            return handle;
+        }
+        for (Endpoint* endpoint : rank_replicas(std::chrono::steady_clock::now())) {
+            if (endpoint == best) {
+                continue;
+            }
+            if (remaining().count() <= 0) {
+                break;
+            }
+            if (auto handle = try_borrow(*endpoint)) {
+                return handle;
+            }
+        }
+    }
+
+    if (!config_.read_fallback_to_primary) {
+        throw std::runtime_error("No replica available for read");
+    }
+    return borrow(primary_endpoint, std::max(remaining(), std::chrono::milliseconds(0)));
+}
+
+bool PoolRouter::evaluate_replica(Endpoint& endpoint, int64_t now_ns, Candidate& candidate) const {
+    if (endpoint.ejected_until.load(std::memory_order_relaxed) > now_ns
+        || endpoint.pool->is_shutdown()) {
+        return false;
+    }
+    auto status = endpoint.pool->get_status();
+    if (status.circuit_open && status.idle_connections == 0) {
+        return false;
+    }
+    candidate.endpoint = &endpoint;
+    candidate.load = static_cast<double>(status.active_connections + status.waiting_requests)
+                     / endpoint.max_connections;
+    candidate.latency = endpoint.latency_ewma_us.load(std::memory_order_relaxed);
+    return true;
+}
+
+PoolRouter::Endpoint* PoolRouter::best_replica(std::chrono::steady_clock::time_point now) const {
+    int64_t now_ns = to_ns(now);
+    Candidate best{};
+    Candidate candidate{};
+    for (size_t i = 1; i < endpoints_.size(); ++i) {
+        if (evaluate_replica(*endpoints_[i], now_ns, candidate)
+            && (!best.endpoint || candidate.better_than(best))) {
+            best = candidate;
+        }
+    }
+    return best.endpoint;
+}
+
+std::vector<PoolRouter::Endpoint*> PoolRouter::rank_replicas(
+    std::chrono::steady_clock::time_point now) const {
+
+    int64_t now_ns = to_ns(now);
+    std::vector<Candidate> candidates;
+    candidates.reserve(endpoints_.size() - 1);
+    Candidate candidate{};
+    for (size_t i = 1; i < endpoints_.size(); ++i) {
+        if (evaluate_replica(*endpoints_[i], now_ns, candidate)) {
+            candidates.push_back(candidate);
+        }
+    }
+
+    std::sort(candidates.begin(), candidates.end(),
+              [](const Candidate& a, const Candidate& b) { return a.better_than(b); });
+
+    std::vector<Endpoint*> ranked;
+    ranked.reserve(candidates.size());
+    for (const auto& candidate : candidates) {
+        ranked.push_back(candidate.endpoint);
+    }
+    return ranked;
+}
+
+PoolConnectionHandle::Ptr PoolRouter::borrow(Endpoint& endpoint,
+                                             std::chrono::milliseconds timeout) {
+    auto start = std::chrono::steady_clock::now();
+    try {
+        auto handle = endpoint.pool->get_connection(timeout);
+        record_success(endpoint, std::chrono::steady_clock::now() - start);
+        return handle;
+    } catch (...) {
+        // 连接全部借出导致的超时只说明繁忙，不计为故障
+        auto status = endpoint.pool->get_status();
+        if (status.active_connections < endpoint.max_connections) {
+            // 主库不剔除，写请求没有其他去处
+            record_failure(endpoint, &endpoint != endpoints_[0].get());
+        }
+        throw;
+    }
+}
+
+void PoolRouter::record_success(Endpoint& endpoint, std::chrono::steady_clock::duration elapsed) {
+    double us = std::chrono::duration<double, std::micro>(elapsed).count();
+    double previous = endpoint.latency_ewma_us.load(std::memory_order_relaxed);
+    double next = previous == 0.0 ? us
+                                  : previous + config_.latency_ewma_alpha * (us - previous);
+    endpoint.latency_ewma_us.store(next, std::memory_order_relaxed);
+
+    if (endpoint.consecutive_failures.exchange(0, std::memory_order_relaxed) > 0
+        && endpoint.ejected_until.exchange(0, std::memory_order_relaxed) != 0) {
+        ODBC_LOG_INFO("Replica re-admitted after successful borrow");
+    }
+}
+
+void PoolRouter::record_failure(Endpoint& endpoint, bool can_eject) {
+    size_t failures = endpoint.consecutive_failures.fetch_add(1, std::memory_order_relaxed) + 1;
+    if (can_eject && failures >= std::max<size_t>(1, config_.eject_threshold)) {
+        auto until = std::chrono::steady_clock::now()
+                     + std::chrono::milliseconds(config_.eject_duration_ms);
+        endpoint.ejected_until.store(to_ns(until), std::memory_order_relaxed);
+        ODBC_LOG_WARN("Replica ejected after " << failures << " consecutive failures");
+    }
+}
+
+std::vector<PoolRouter::EndpointStatus> PoolRouter::get_status() const {
+    int64_t now_ns = to_ns(std::chrono::steady_clock::now());
+    std::vector<EndpointStatus> result;
+    result.reserve(endpoints_.size());
+    for (size_t i = 0; i < endpoints_.size(); ++i) {
+        const Endpoint& endpoint = *endpoints_[i];
+        result.push_back(EndpointStatus{
+            .primary = i == 0,
+            .ejected = endpoint.ejected_until.load(std::memory_order_relaxed) > now_ns,
+            .consecutive_failures = endpoint.consecutive_failures.load(std::memory_order_relaxed),
+            .latency_ewma_us = endpoint.latency_ewma_us.load(std::memory_order_relaxed),
+            .pool = endpoint.pool->get_status()
+        });
+    }
+    return result;
+}
+
+void PoolRouter::shutdown() {
+    for (auto& endpoint : endpoints_) {
+        endpoint->pool->shutdown();
+    }
+}
+
+} // namespace odbc
@@ -0,0 +1,165 @@
+#ifndef __ODBC_POOL_ROUTER_H__
+#define __ODBC_POOL_ROUTER_H__
+
+#include "odbc_connection_pool.h"
+#include <memory>
+#include <vector>
+#include <atomic>
+#include <chrono>
+#include <string>
+
+namespace odbc {
+
+/**
+ * @brief 访问类型，写请求只走主库
+ */
+enum class AccessMode {
+    Read,
+    Write
+};
+
+/**
+ * @brief 读写分离路由配置
+ */
+struct PoolRouterConfig {
+    ConnectionPoolConfig primary;                ///< 主库连接池
+    std::vector<ConnectionPoolConfig> replicas;  ///< 从库连接池，按各自的connection_config连接
+
+    size_t replica_timeout_ms = 1000;   ///< 从单个从库借连接的超时(毫秒)，超时后尝试下一个
+    size_t eject_threshold = 3;         ///< 连续借用失败达到此次数时剔除从库
+    size_t eject_duration_ms = 10000;   ///< 剔除时长(毫秒)，到期后重新参与路由
+    bool read_fallback_to_primary = true;  ///< 所有从库不可用时读请求走主库
+    double latency_ewma_alpha = 0.2;    ///< 借用延迟(借到连接的耗时，不含执行)滑动平均的权重
+};
+
+/**
+ * @brief 一主多从的连接池路由
+ *
+ * 每个端点是独立的ConnectionPool。读请求按负载(借出与等待数占max_connections的比例)
+ * 选择健康从库，负载相同时选借用延迟低者；借用延迟是从该端点连接池借到连接的耗时的滑动平均，
+ * 不含查询执行时间。从库借用失败时再按同样顺序依次尝试其他从库。
+ * 连续失败(连接未借满时借用失败)的从库在eject_duration_ms内不参与路由，到期后重新接受请求，一次成功即恢复。
+ */
+class PoolRouter {
+public:
+    using Ptr = std::shared_ptr<PoolRouter>;
+    explicit PoolRouter(const PoolRouterConfig& config);
+    ~PoolRouter();
+
+    // 禁止拷贝
+    PoolRouter(const PoolRouter&) = delete;
+    PoolRouter& operator=(const PoolRouter&) = delete;
+
+    /**
+     * @brief 按访问类型获取连接，timeout为总超时
+     */
+    PoolConnectionHandle::Ptr get_connection(
+        AccessMode mode,
+        std::chrono::milliseconds timeout = std::chrono::milliseconds(5000));
+
+    PoolConnectionHandle::Ptr get_read_connection(
+        std::chrono::milliseconds timeout = std::chrono::milliseconds(5000)) {
+        return get_connection(AccessMode::Read, timeout);
+    }
+
+    PoolConnectionHandle::Ptr get_write_connection(
+        std::chrono::milliseconds timeout = std::chrono::milliseconds(5000)) {
+        return get_connection(AccessMode::Write, timeout);
+    }
+
+    /**
+     * @brief 在从库上查询
+     */
+    ResultSet query(const std::string& sql) {
+        return get_read_connection()->query(sql);
+    }
+
+    /**
+     * @brief 在主库上执行
+     */
+    size_t execute(const std::string& sql) {
+        return get_write_connection()->execute(sql);
+    }
+
+    /**
+     * @brief 端点状态
+     */
+    struct EndpointStatus {
+        bool primary;
+        bool ejected;
+        size_t consecutive_failures;
+        double latency_ewma_us;       ///< 借用延迟滑动平均(微秒)
+        ConnectionPool::PoolStatus pool;
+    };
+
+    /**
+     * @brief 各端点状态，下标0为主库
+     */
+    std::vector<EndpointStatus> get_status() const;
+
+    /**
+     * @brief 主库连接池
+     */
+    ConnectionPool::Ptr primary() const { return endpoints_[0]->pool; }
+
+    /**
+     * @brief 关闭所有连接池
+     */
+    void shutdown();
+
+private:
+    struct Endpoint {
+        ConnectionPool::Ptr pool;
+        size_t max_connections;
+        std::atomic<size_t> consecutive_failures{0};
+        std::atomic<int64_t> ejected_until{0};     ///< steady_clock纳秒，0表示未剔除
+        std::atomic<double> latency_ewma_us{0.0};
+    };
+
+    struct Candidate {
+        Endpoint* endpoint = nullptr;
+        double load = 0;
+        double latency = 0;
+
+        bool better_than(const Candidate& other) const {
+            if (load != other.load) {
+                return load < other.load;
+            }
+            return latency < other.latency;
+        }
+    };
+
+    /**
+     * @brief 从库可参与路由时填写其负载与延迟
+     */
+    bool evaluate_replica(Endpoint& endpoint, int64_t now_ns, Candidate& candidate) const;
+
+    /**
+     * @brief 负载和延迟最低的可用从库，没有时为nullptr，不分配内存
+     */
+    Endpoint* best_replica(std::chrono::steady_clock::time_point now) const;
+
+    /**
+     * @brief 按负载和延迟排序的可用从库，仅在最优从库借用失败后使用
+     */
+    std::vector<Endpoint*> rank_replicas(std::chrono::steady_clock::time_point now) const;
+
+    /**
+     * @brief 在指定端点借连接，记录延迟与失败
+     */
+    PoolConnectionHandle::Ptr borrow(Endpoint& endpoint, std::chrono::milliseconds timeout);
+
+    void record_success(Endpoint& endpoint, std::chrono::steady_clock::duration elapsed);
+    void record_failure(Endpoint& endpoint, bool can_eject);
+
+    static int64_t to_ns(std::chrono::steady_clock::time_point t) {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(t.time_since_epoch()).count();
+    }
+
+    PoolRouterConfig config_;
+    std::vector<std::unique_ptr<Endpoint>> endpoints_;  ///< 下标0为主库
+};
+
+} // namespace odbc
+
+#endif // __ODBC_POOL_ROUTER_H__
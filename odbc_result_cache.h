@@ -0,0 +1,340 @@
+#ifndef __ODBC_RESULT_CACHE_H__
+#define __ODBC_RESULT_CACHE_H__
+
+#include "odbc_wrapper.h"
+#include <chrono>
+#include <cstring>
+#include <functional>
+#include <future>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <type_traits>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace odbc {
+
+/**
+ * @brief 单次缓存查询的选项
+ */
+struct QueryCacheOptions {
+    std::chrono::milliseconds ttl{0};   ///< 有效期，0为使用连接池的result_cache_ttl_ms
+    std::vector<std::string> tags;      ///< 失效标签，通常为涉及的表名
+};
+
+/**
+ * @brief 结果缓存统计
+ */
+struct ResultCacheStats {
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+    uint64_t coalesced = 0;     ///< 等待同一键正在进行的查询而未单独执行的次数
+    uint64_t evictions = 0;     ///< 因容量被淘汰的条目数
+    size_t entries = 0;
+    size_t bytes = 0;
+};
+
+/**
+ * @brief 缓存键编码，SQL文本后依次追加带类型标记的参数
+ */
+namespace cache_key {
+
+inline void append_raw(std::string& key, char tag, const void* data, size_t size) {
+    key.push_back(tag);
+    key.append(static_cast<const char*>(data), size);
+}
+
+// 算术类型的类别标记，相同位模式的int32_t与float、int64_t与double、bool与char不能得到相同的键
+template<typename T>
+constexpr char arithmetic_kind() {
+    return std::is_same<T, bool>::value ? 'B'
+         : std::is_same<T, char>::value ? 'C'
+         : std::is_floating_point<T>::value ? 'F'
+         : std::is_signed<T>::value ? 'I' : 'U';
+}
+
+template<typename T>
+inline typename std::enable_if<std::is_arithmetic<T>::value>::type
+append(std::string& key, const T& value) {
+    key.push_back(arithmetic_kind<T>());
+    append_raw(key, static_cast<char>('0' + sizeof(T)), &value, sizeof(T));
+}
+
+inline void append(std::string& key, const char* value) {
+    size_t size = value ? std::strlen(value) : 0;
+    append_raw(key, 's', &size, sizeof(size));
+    key.append(value ? value : "", size);
+}
+
+inline void append(std::string& key, const std::string& value) {
+    size_t size = value.size();
+    append_raw(key, 's', &size, sizeof(size));
+    key.append(value);
+}
+
+inline void append(std::string& key, const std::vector<unsigned char>& value) {
+    size_t size = value.size();
+    append_raw(key, 'b', &size, sizeof(size));
+    key.append(reinterpret_cast<const char*>(value.data()), size);
+}
+
+inline void append(std::string& key, const TIMESTAMP_STRUCT& value) {
+    append_raw(key, 't', &value, sizeof(value));
+}
+
+inline void append(std::string& key, const std::chrono::system_clock::time_point& value) {
+    auto ticks = value.time_since_epoch().count();
+    append_raw(key, 'p', &ticks, sizeof(ticks));
+}
+
+inline void append(std::string& key, std::nullptr_t) {
+    key.push_back('n');
+}
+
+template<typename... Args>
+inline std::string build(const std::string& sql, const Args&... params) {
+    std::string key;
+    key.reserve(sql.size() + 1 + sizeof...(Args) * 10);
+    key.append(sql);
+    key.push_back('\0');
+    int expand[] = {0, (append(key, params), 0)...};
+    (void)expand;
+    return key;
+}
+
+} // namespace cache_key
+
+/**
+ * @brief 带TTL与LRU淘汰的查询结果缓存
+ *
+ * 结果以shared_ptr<const ResultSet>共享，命中时不复制数据。
+ * 同一键的并发未命中只执行一次加载，其余调用等待其结果。
+ * 加载期间其标签被失效或缓存被清空时，结果仍返回给本次调用者但不写入缓存，
+ * 其他标签的失效不影响。
+ */
+class ResultCache {
+public:
+    using ResultPtr = std::shared_ptr<const ResultSet>;
+    using Loader = std::function<ResultSet()>;
+
+    explicit ResultCache(size_t capacity_bytes)
+        : capacity_bytes_(capacity_bytes) {}
+
+    ResultCache(const ResultCache&) = delete;
+    ResultCache& operator=(const ResultCache&) = delete;
+
+    /**
+     * @brief 命中则直接返回，否则调用loader并缓存
+     */
+    ResultPtr get_or_load(const std::string& key, std::chrono::milliseconds ttl,
+                          const std::vector<std::string>& tags, const Loader& loader) {
+        auto now = std::chrono::steady_clock::now();
+        std::shared_ptr<std::promise<ResultPtr>> promise;
+        std::shared_future<ResultPtr> pending;
+        uint64_t epoch = 0;
+        std::vector<uint64_t> tag_epochs;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            auto it = index_.find(key);
+            if (it != index_.end()) {
+                if (it->second->expires > now) {
+                    lru_.splice(lru_.begin(), lru_, it->second);
+                    hits_++;
+                    return it->second->result;
+                }
+                erase_locked(it->second);
+            }
+
+            auto flight = in_flight_.find(key);
+            if (flight != in_flight_.end()) {
+                coalesced_++;
+                pending = flight->second;
+            } else {
+                misses_++;
+                promise = std::make_shared<std::promise<ResultPtr>>();
+                in_flight_.emplace(key, promise->get_future().share());
+                epoch = epoch_;
+                tag_epochs.reserve(tags.size());
+                for (const auto& tag : tags) {
+                    TagState& state = tags_[tag];
+                    state.loading++;
+                    tag_epochs.push_back(state.epoch);
+                }
+            }
+        }
+
+        if (!promise) {
+            return pending.get();
+        }
+
+        ResultPtr result;
+        try {
+            result = std::make_shared<const ResultSet>(loader());
+        } catch (...) {
+            std::lock_guard<std::mutex> lock(mutex_);
+            in_flight_.erase(key);
+            finish_load_locked(tags, tag_epochs);
+            promise->set_exception(std::current_exception());
+            throw;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            in_flight_.erase(key);
+            bool current = finish_load_locked(tags, tag_epochs) && epoch == epoch_;
+            if (current) {
+                insert_locked(key, result, std::chrono::steady_clock::now() + ttl, tags);
+            }
+        }
+        promise->set_value(result);
+        return result;
+    }
+
+    /**
+     * @brief 使带有该标签的条目失效
+     */
+    void invalidate(const std::string& tag) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        // 没有条目也没有加载使用的标签无需处理
+        auto it = tags_.find(tag);
+        if (it == tags_.end()) {
+            return;
+        }
+        it->second.epoch++;
+        std::unordered_set<std::string> keys = std::move(it->second.keys);
+        it->second.keys.clear();
+        if (it->second.loading == 0) {
+            tags_.erase(it);
+        }
+        for (const auto& key : keys) {
+            auto entry = index_.find(key);
+            if (entry != index_.end()) {
+                erase_locked(entry->second);
+            }
+        }
+    }
+
+    /**
+     * @brief 清空缓存
+     */
+    void clear() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        epoch_++;
+        lru_.clear();
+        index_.clear();
+        // 保留加载中的标签计数，加载结束时据此清理
+        for (auto it = tags_.begin(); it != tags_.end();) {
+            it->second.keys.clear();
+            if (it->second.loading == 0) {
+                it = tags_.erase(it);
+            } else {
+                ++it;
+            }
+        }
+        bytes_ = 0;
+    }
+
+    ResultCacheStats stats() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        ResultCacheStats result;
+        result.hits = hits_;
+        result.misses = misses_;
+        result.coalesced = coalesced_;
+        result.evictions = evictions_;
+        result.entries = index_.size();
+        result.bytes = bytes_;
+        return result;
+    }
+
+private:
+    struct Entry {
+        std::string key;
+        ResultPtr result;
+        std::chrono::steady_clock::time_point expires;
+        std::vector<std::string> tags;
+        size_t bytes;
+    };
+    using EntryList = std::list<Entry>;
+
+    struct TagState {
+        std::unordered_set<std::string> keys;   ///< 带有该标签的条目
+        uint64_t epoch = 0;                     ///< 每次失效递增，用于丢弃失效前开始的加载
+        size_t loading = 0;                     ///< 使用该标签的进行中加载数
+    };
+
+    // 结束一次加载的标签登记，返回加载期间其标签是否都未失效
+    bool finish_load_locked(const std::vector<std::string>& tags,
+                            const std::vector<uint64_t>& tag_epochs) {
+        bool current = true;
+        for (size_t i = 0; i < tags.size(); ++i) {
+            auto it = tags_.find(tags[i]);
+            if (it == tags_.end()) {
+                continue;
+            }
+            current = current && it->second.epoch == tag_epochs[i];
+            if (--it->second.loading == 0 && it->second.keys.empty()) {
+                tags_.erase(it);
+            }
+        }
+        return current;
+    }
+
+    void insert_locked(const std::string& key, const ResultPtr& result,
+                       std::chrono::steady_clock::time_point expires,
+                       const std::vector<std::string>& tags) {
+        size_t bytes = result->memory_usage() + key.size() * 2 + sizeof(Entry);
+        if (bytes > capacity_bytes_) {
+            return;
+        }
+        auto existing = index_.find(key);
+        if (existing != index_.end()) {
+            erase_locked(existing->second);
+        }
+        while (bytes_ + bytes > capacity_bytes_ && !lru_.empty()) {
+            erase_locked(std::prev(lru_.end()));
+            evictions_++;
+        }
+
+        lru_.push_front(Entry{key, result, expires, tags, bytes});
+        index_.emplace(key, lru_.begin());
+        for (const auto& tag : tags) {
+            tags_[tag].keys.insert(key);
+        }
+        bytes_ += bytes;
+    }
+
+    void erase_locked(EntryList::iterator entry) {
+        for (const auto& tag : entry->tags) {
+            auto it = tags_.find(tag);
+            if (it != tags_.end()) {
+                it->second.keys.erase(entry->key);
+                if (it->second.keys.empty() && it->second.loading == 0) {
+                    tags_.erase(it);
+                }
+            }
+        }
+        bytes_ -= entry->bytes;
+        index_.erase(entry->key);
+        lru_.erase(entry);
+    }
+
+    const size_t capacity_bytes_;
+    mutable std::mutex mutex_;
+    EntryList lru_;                                                   ///< 队首为最近使用
+    std::unordered_map<std::string, EntryList::iterator> index_;
+    std::unordered_map<std::string, TagState> tags_;
+    std::unordered_map<std::string, std::shared_future<ResultPtr>> in_flight_;
+    size_t bytes_ = 0;
+    uint64_t epoch_ = 0;          ///< 每次清空递增，用于丢弃清空前开始的加载
+    uint64_t hits_ = 0;
+    uint64_t misses_ = 0;
+    uint64_t coalesced_ = 0;
+    uint64_t evictions_ = 0;
+};
+
+} // namespace odbc
+
+#endif // __ODBC_RESULT_CACHE_H__
@@ -21,8 +21,20 @@
 #include <atomic>
 #include <thread>
 #include <unordered_map>
+#include <list>
+#include <tuple>
+#include <optional>
+#include <string_view>
+#include <cstdint>
+#include <utility>
+#include <algorithm>
+#include <cstring>
+#include <cstdlib>
+#include <ctime>
+#include <cstdio>
 
-#include <boost/any.hpp>
+#include "odbc_logger.h"
+#include "odbc_metrics.h"
 
 namespace odbc {
 
@@ -121,41 +133,279 @@ using EnvironmentHandle = OdbcHandle<SQL_HANDLE_ENV>;
 using ConnectionHandle = OdbcHandle<SQL_HANDLE_DBC>;
 using StatementHandle = OdbcHandle<SQL_HANDLE_STMT>;
 
+// 共享的ODBC环境句柄
+// 通过shared_ptr引用计数，由连接池持有并传给每个连接，最后一个连接释放后才销毁
+class Environment {
+public:
+    using Ptr = std::shared_ptr<Environment>;
+    
+    // connection_pooling为true时启用驱动管理器连接池(SQL_ATTR_CONNECTION_POOLING)
+    explicit Environment(bool connection_pooling = false)
+        : connection_pooling_(enable_process_pooling(connection_pooling)) {
+        
+        handle_.check(
+            SQLSetEnvAttr(handle_.get(), SQL_ATTR_ODBC_VERSION, 
+                        (void*)SQL_OV_ODBC3, 0),
+            "Set ODBC version"
+        );
+        
+        if (connection_pooling_) {
+            SQLSetEnvAttr(handle_.get(), SQL_ATTR_CP_MATCH,
+                          (SQLPOINTER)SQL_CP_RELAXED_MATCH, 0);
+        }
+    }
+    
+    Environment(const Environment&) = delete;
+    Environment& operator=(const Environment&) = delete;
+    
+    static Ptr create(bool connection_pooling = false) {
+        return std::make_shared<Environment>(connection_pooling);
+    }
+    
+    // 进程级共享环境，驱动管理器连接池依赖环境句柄长期存在
+    static Ptr process_shared(bool connection_pooling = false) {
+        static std::mutex mutex;
+        static Ptr plain_env;
+        static Ptr pooled_env;
+        
+        std::lock_guard<std::mutex> lock(mutex);
+        Ptr& env = connection_pooling ? pooled_env : plain_env;
+        if (!env) {
+            env = create(connection_pooling);
+        }
+        return env;
+    }
+    
+    SQLHENV get() const noexcept { return handle_.get(); }
+    bool connection_pooling() const noexcept { return connection_pooling_; }
+    
+private:
+    // 进程级属性，必须在分配环境句柄之前设置
+    static bool enable_process_pooling(bool enable) {
+        if (enable) {
+            SQLRETURN ret = SQLSetEnvAttr(SQL_NULL_HANDLE, SQL_ATTR_CONNECTION_POOLING,
+                                          (SQLPOINTER)SQL_CP_ONE_PER_HENV, 0);
+            if (!SQL_SUCCEEDED(ret)) {
+                throw std::runtime_error("Failed to enable driver manager pooling");
+            }
+        }
+        return enable;
+    }
+    
+    bool connection_pooling_;   // 必须先于handle_声明
+    EnvironmentHandle handle_;
+};
+
+// 日期时间与本地时间点互相转换，与参数绑定一致按本地时区解释，精确到微秒
+inline TIMESTAMP_STRUCT to_timestamp_struct(const std::chrono::system_clock::time_point& tp) {
+    auto micros = std::chrono::duration_cast<std::chrono::microseconds>(
+        tp.time_since_epoch()).count();
+    std::time_t seconds = static_cast<std::time_t>(micros / 1000000);
+    long fraction = static_cast<long>(micros % 1000000);
+    if (fraction < 0) {
+        fraction += 1000000;
+        --seconds;
+    }
+    std::tm tm_val;
+    localtime_r(&seconds, &tm_val);
+    
+    TIMESTAMP_STRUCT ts;
+    ts.year = static_cast<SQLSMALLINT>(tm_val.tm_year + 1900);
+    ts.month = static_cast<SQLUSMALLINT>(tm_val.tm_mon + 1);
+    ts.day = static_cast<SQLUSMALLINT>(tm_val.tm_mday);
+    ts.hour = static_cast<SQLUSMALLINT>(tm_val.tm_hour);
+    ts.minute = static_cast<SQLUSMALLINT>(tm_val.tm_min);
+    ts.second = static_cast<SQLUSMALLINT>(tm_val.tm_sec);
+    ts.fraction = static_cast<SQLUINTEGER>(fraction * 1000);
+    return ts;
+}
+
+inline std::chrono::system_clock::time_point to_time_point(const TIMESTAMP_STRUCT& ts) {
+    std::tm tm_val = {};
+    tm_val.tm_year = ts.year - 1900;
+    tm_val.tm_mon = ts.month - 1;
+    tm_val.tm_mday = ts.day;
+    tm_val.tm_hour = ts.hour;
+    tm_val.tm_min = ts.minute;
+    tm_val.tm_sec = ts.second;
+    tm_val.tm_isdst = -1;
+    auto tp = std::chrono::system_clock::from_time_t(std::mktime(&tm_val));
+    return tp + std::chrono::duration_cast<std::chrono::system_clock::duration>(
+        std::chrono::nanoseconds(ts.fraction));
+}
+
+inline std::string format_date(SQLSMALLINT year, SQLUSMALLINT month, SQLUSMALLINT day) {
+    char buf[16];
+    int n = std::snprintf(buf, sizeof(buf), "%04d-%02u-%02u", year, month, day);
+    return std::string(buf, n);
+}
+
+inline std::string format_timestamp(const TIMESTAMP_STRUCT& ts) {
+    char buf[48];
+    int n = std::snprintf(buf, sizeof(buf), "%04d-%02u-%02u %02u:%02u:%02u",
+                          ts.year, ts.month, ts.day, ts.hour, ts.minute, ts.second);
+    if (ts.fraction > 0) {
+        n += std::snprintf(buf + n, sizeof(buf) - n, ".%09u", static_cast<unsigned>(ts.fraction));
+    }
+    return std::string(buf, n);
+}
+
+// 定点小数：unscaled * 10^-scale，覆盖精度不超过18位的DECIMAL/NUMERIC
+struct Decimal {
+    static constexpr uint8_t kMaxDigits = 18;
+    
+    SQLBIGINT unscaled = 0;
+    uint8_t scale = 0;
+    
+    // 解析驱动返回的十进制文本，如"-123.4500"
+    static Decimal parse(const char* data, size_t len) {
+        Decimal d;
+        size_t i = 0;
+        while (i < len && data[i] == ' ') ++i;
+        while (len > i && (data[len - 1] == ' ' || data[len - 1] == '\0')) --len;
+        bool negative = false;
+        if (i < len && (data[i] == '-' || data[i] == '+')) {
+            negative = data[i] == '-';
+            ++i;
+        }
+        bool fraction = false;
+        bool any_digit = false;
+        uint64_t value = 0;
+        for (; i < len; ++i) {
+            char ch = data[i];
+            if (ch == '.' && !fraction) {
+                fraction = true;
+                continue;
+            }
+            if (ch < '0' || ch > '9') {
+                throw std::runtime_error("Invalid decimal value: " + std::string(data, len));
+            }
+            if (value > (static_cast<uint64_t>(INT64_MAX) - (ch - '0')) / 10) {
+                throw std::overflow_error("Decimal value out of range: " + std::string(data, len));
+            }
+            value = value * 10 + (ch - '0');
+            any_digit = true;
+            if (fraction) {
+                ++d.scale;
+            }
+        }
+        if (!any_digit) {
+            throw std::runtime_error("Invalid decimal value: " + std::string(data, len));
+        }
+        d.unscaled = negative ? -static_cast<SQLBIGINT>(value) : static_cast<SQLBIGINT>(value);
+        return d;
+    }
+    
+    double to_double() const {
+        double v = static_cast<double>(unscaled);
+        for (uint8_t i = 0; i < scale; ++i) {
+            v /= 10.0;
+        }
+        return v;
+    }
+    
+    std::string to_string() const {
+        uint64_t magnitude = unscaled < 0 ? 0 - static_cast<uint64_t>(unscaled)
+                                          : static_cast<uint64_t>(unscaled);
+        std::string digits = std::to_string(magnitude);
+        if (digits.size() <= scale) {
+            digits.insert(0, scale - digits.size() + 1, '0');
+        }
+        if (scale > 0) {
+            digits.insert(digits.size() - scale, 1, '.');
+        }
+        if (unscaled < 0) {
+            digits.insert(0, 1, '-');
+        }
+        return digits;
+    }
+};
+
 // 值类型包装
+// 紧凑表示：标量、日期时间、定点数与短字符串(不超过kInlineCapacity字节)内联存储，
+// 长字符串单独分配，整体16字节；日期时间与定点数在转为字符串时才格式化
 class Value {
 public:
-    enum class Type {
+    enum class Type : uint8_t {
         Null,
         Integer,
         Long,
         Double,
         String,
         Timestamp,
-        Boolean
+        Boolean,
+        Date,
+        Decimal
     };
     
-    Value() : type_(Type::Null) {}
+    static constexpr size_t kInlineCapacity = 14;
+    
+    Value() : size_(0), type_(Type::Null) {}
     
-    explicit Value(SQLINTEGER val) 
-        : type_(Type::Integer), int_val_(val) {}
+    explicit Value(SQLINTEGER val) : size_(0), type_(Type::Integer) { store(val); }
     
-    explicit Value(SQLBIGINT val) 
-        : type_(Type::Long), long_val_(val) {}
+    explicit Value(SQLBIGINT val) : size_(0), type_(Type::Long) { store(val); }
     
-    explicit Value(double val) 
-        : type_(Type::Double), double_val_(val) {}
+    explicit Value(double val) : size_(0), type_(Type::Double) { store(val); }
     
-    explicit Value(const std::string& val) 
-        : type_(Type::String), str_val_(val) {}
+    explicit Value(const std::string& val) : Value(val.data(), val.size()) {}
     
-    explicit Value(const char* val) 
-        : type_(Type::String), str_val_(val) {}
+    explicit Value(const char* val) : Value(val, std::strlen(val)) {}
     
-    explicit Value(bool val) 
-        : type_(Type::Boolean), bool_val_(val) {}
+    // 直接从缓冲区构造字符串值
+    Value(const char* data, size_t len) : type_(Type::String) { assign_string(data, len); }
+    
+    explicit Value(bool val) : size_(0), type_(Type::Boolean) { store(val); }
     
     explicit Value(const std::chrono::system_clock::time_point& tp)
-        : type_(Type::Timestamp), timestamp_val_(tp) {}
+        : Value(to_timestamp_struct(tp)) {}
+    
+    explicit Value(const TIMESTAMP_STRUCT& ts) : size_(0), type_(Type::Timestamp) {
+        store(PackedDateTime::from(ts));
+    }
+    
+    explicit Value(const DATE_STRUCT& date) : size_(0), type_(Type::Date) {
+        TIMESTAMP_STRUCT ts = {};
+        ts.year = date.year;
+        ts.month = date.month;
+        ts.day = date.day;
+        store(PackedDateTime::from(ts));
+    }
+    
+    explicit Value(const odbc::Decimal& dec) : size_(0), type_(Type::Decimal) {
+        store(dec.unscaled);
+        store(dec.scale, sizeof(SQLBIGINT));
+    }
+    
+    Value(const Value& other) : size_(0), type_(Type::Null) { copy_from(other); }
+    
+    Value(Value&& other) noexcept : size_(other.size_), type_(other.type_) {
+        std::memcpy(storage_, other.storage_, sizeof(storage_));
+        other.size_ = 0;
+        other.type_ = Type::Null;
+    }
+    
+    Value& operator=(const Value& other) {
+        if (this != &other) {
+            release();
+            copy_from(other);
+        }
+        return *this;
+    }
+    
+    Value& operator=(Value&& other) noexcept {
+        if (this != &other) {
+            release();
+            std::memcpy(storage_, other.storage_, sizeof(storage_));
+            size_ = other.size_;
+            type_ = other.type_;
+            other.size_ = 0;
+            other.type_ = Type::Null;
+        }
+        return *this;
+    }
+    
+    ~Value() { release(); }
     
     // 转换为目标类型
     template<typename T>
@@ -164,46 +414,513 @@ public:
     Type type() const { return type_; }
     bool is_null() const { return type_ == Type::Null; }
     
+    // 字符串内容视图，非字符串类型返回空
+    std::string_view str() const {
+        if (type_ != Type::String) {
+            return std::string_view();
+        }
+        if (size_ == kHeapTag) {
+            return std::string_view(load<const char*>(), load<uint32_t>(sizeof(char*)));
+        }
+        return std::string_view(storage_, size_);
+    }
+    
 private:
+    static constexpr uint8_t kHeapTag = 0xFF;  ///< size_取此值表示字符串在堆上
+    
+    // TIMESTAMP_STRUCT按字段压缩到12字节
+    struct PackedDateTime {
+        int16_t year;
+        uint8_t month, day, hour, minute, second, reserved;
+        uint32_t fraction;  ///< 纳秒
+        
+        static PackedDateTime from(const TIMESTAMP_STRUCT& ts) {
+            return PackedDateTime{ts.year, static_cast<uint8_t>(ts.month),
+                                  static_cast<uint8_t>(ts.day), static_cast<uint8_t>(ts.hour),
+                                  static_cast<uint8_t>(ts.minute), static_cast<uint8_t>(ts.second),
+                                  0, ts.fraction};
+        }
+        
+        TIMESTAMP_STRUCT to_struct() const {
+            TIMESTAMP_STRUCT ts;
+            ts.year = year;
+            ts.month = month;
+            ts.day = day;
+            ts.hour = hour;
+            ts.minute = minute;
+            ts.second = second;
+            ts.fraction = fraction;
+            return ts;
+        }
+    };
+    
+    template<typename T>
+    void store(const T& val, size_t offset = 0) {
+        static_assert(std::is_trivially_copyable<T>::value, "Value payload must be trivially copyable");
+        std::memcpy(storage_ + offset, &val, sizeof(T));
+    }
+    
+    template<typename T>
+    T load(size_t offset = 0) const {
+        T val;
+        std::memcpy(&val, storage_ + offset, sizeof(T));
+        return val;
+    }
+    
+    void assign_string(const char* data, size_t len) {
+        if (len <= kInlineCapacity) {
+            std::memcpy(storage_, data, len);
+            size_ = static_cast<uint8_t>(len);
+            return;
+        }
+        if (len > UINT32_MAX) {
+            throw std::length_error("String value too long");
+        }
+        char* heap = new char[len];
+        std::memcpy(heap, data, len);
+        store(static_cast<const char*>(heap));
+        store(static_cast<uint32_t>(len), sizeof(char*));
+        size_ = kHeapTag;
+    }
+    
+    void copy_from(const Value& other) {
+        type_ = other.type_;
+        if (other.type_ == Type::String && other.size_ == kHeapTag) {
+            std::string_view s = other.str();
+            assign_string(s.data(), s.size());
+            return;
+        }
+        std::memcpy(storage_, other.storage_, sizeof(storage_));
+        size_ = other.size_;
+    }
+    
+    void release() {
+        if (type_ == Type::String && size_ == kHeapTag) {
+            delete[] load<const char*>();
+        }
+        size_ = 0;
+    }
+    
+    std::string string_value() const {
+        std::string_view s = str();
+        return std::string(s.data(), s.size());
+    }
+    
+    SQLINTEGER int_val() const { return load<SQLINTEGER>(); }
+    SQLBIGINT long_val() const { return load<SQLBIGINT>(); }
+    double double_val() const { return load<double>(); }
+    bool bool_val() const { return load<bool>(); }
+    TIMESTAMP_STRUCT timestamp_val() const { return load<PackedDateTime>().to_struct(); }
+    odbc::Decimal decimal_val() const {
+        odbc::Decimal dec;
+        dec.unscaled = load<SQLBIGINT>();
+        dec.scale = load<uint8_t>(sizeof(SQLBIGINT));
+        return dec;
+    }
+    
+    alignas(8) char storage_[kInlineCapacity];  ///< 标量、日期时间、内联字符串或堆指针+长度
+    uint8_t size_;                              ///< 内联字符串长度或kHeapTag
     Type type_;
-    union {
-        SQLINTEGER int_val_;
-        SQLBIGINT long_val_;
-        double double_val_;
-        bool bool_val_;
-        std::chrono::system_clock::time_point timestamp_val_;
+};
+
+static_assert(sizeof(Value) == 16, "Value is expected to stay 16 bytes");
+
+// Value类型的转换实现
+template<>
+inline int Value::as<int>() const {
+    switch (type_) {
+        case Type::Integer: return static_cast<int>(int_val());
+        case Type::Long: return static_cast<int>(long_val());
+        case Type::Double: return static_cast<int>(double_val());
+        case Type::Boolean: return bool_val() ? 1 : 0;
+        case Type::String: return std::stoi(string_value());
+        case Type::Decimal: return static_cast<int>(decimal_val().to_double());
+        case Type::Null: throw std::runtime_error("Cannot convert NULL to int");
+        default: throw std::runtime_error("Invalid type conversion to int");
+    }
+}
+
+template<>
+inline long long Value::as<long long>() const {
+    switch (type_) {
+        case Type::Integer: return static_cast<long long>(int_val());
+        case Type::Long: return long_val();
+        case Type::Double: return static_cast<long long>(double_val());
+        case Type::Boolean: return bool_val() ? 1 : 0;
+        case Type::String: return std::stoll(string_value());
+        case Type::Decimal: {
+            odbc::Decimal dec = decimal_val();
+            long long v = dec.unscaled;
+            for (uint8_t i = 0; i < dec.scale; ++i) {
+                v /= 10;
+            }
+            return v;
+        }
+        case Type::Null: throw std::runtime_error("Cannot convert NULL to long long");
+        default: throw std::runtime_error("Invalid type conversion to long long");
+    }
+}
+
+template<>
+inline double Value::as<double>() const {
+    switch (type_) {
+        case Type::Integer: return static_cast<double>(int_val());
+        case Type::Long: return static_cast<double>(long_val());
+        case Type::Double: return double_val();
+        case Type::Boolean: return bool_val() ? 1.0 : 0.0;
+        case Type::String: return std::stod(string_value());
+        case Type::Decimal: return decimal_val().to_double();
+        case Type::Null: throw std::runtime_error("Cannot convert NULL to double");
+        default: throw std::runtime_error("Invalid type conversion to double");
+    }
+}
+
+template<>
+inline std::string Value::as<std::string>() const {
+    switch (type_) {
+        case Type::Integer: return std::to_string(int_val());
+        case Type::Long: return std::to_string(long_val());
+        case Type::Double: return std::to_string(double_val());
+        case Type::Boolean: return bool_val() ? "true" : "false";
+        case Type::String: return string_value();
+        case Type::Timestamp: return format_timestamp(timestamp_val());
+        case Type::Date: {
+            TIMESTAMP_STRUCT ts = timestamp_val();
+            return format_date(ts.year, ts.month, ts.day);
+        }
+        case Type::Decimal: return decimal_val().to_string();
+        case Type::Null: return "NULL";
+        default: throw std::runtime_error("Invalid type conversion to string");
+    }
+}
+
+template<>
+inline bool Value::as<bool>() const {
+    switch (type_) {
+        case Type::Integer: return int_val() != 0;
+        case Type::Long: return long_val() != 0;
+        case Type::Double: return double_val() != 0.0;
+        case Type::Boolean: return bool_val();
+        case Type::Decimal: return decimal_val().unscaled != 0;
+        case Type::String: {
+            std::string lower = string_value();
+            std::transform(lower.begin(), lower.end(), lower.begin(), ::tolower);
+            return lower == "true" || lower == "1" || lower == "yes" || lower == "on";
+        }
+        case Type::Null: return false;
+        default: throw std::runtime_error("Invalid type conversion to bool");
+    }
+}
+
+template<>
+inline TIMESTAMP_STRUCT Value::as<TIMESTAMP_STRUCT>() const {
+    if (type_ != Type::Timestamp && type_ != Type::Date) {
+        throw std::runtime_error("Cannot convert non-timestamp to TIMESTAMP_STRUCT");
+    }
+    return timestamp_val();
+}
+
+template<>
+inline DATE_STRUCT Value::as<DATE_STRUCT>() const {
+    if (type_ != Type::Timestamp && type_ != Type::Date) {
+        throw std::runtime_error("Cannot convert non-timestamp to DATE_STRUCT");
+    }
+    TIMESTAMP_STRUCT ts = timestamp_val();
+    DATE_STRUCT date;
+    date.year = ts.year;
+    date.month = ts.month;
+    date.day = ts.day;
+    return date;
+}
+
+template<>
+inline std::chrono::system_clock::time_point Value::as<std::chrono::system_clock::time_point>() const {
+    return to_time_point(as<TIMESTAMP_STRUCT>());
+}
+
+template<>
+inline odbc::Decimal Value::as<odbc::Decimal>() const {
+    switch (type_) {
+        case Type::Decimal: return decimal_val();
+        case Type::Integer: return odbc::Decimal{int_val(), 0};
+        case Type::Long: return odbc::Decimal{long_val(), 0};
+        case Type::String: {
+            std::string_view s = str();
+            return odbc::Decimal::parse(s.data(), s.size());
+        }
+        case Type::Null: throw std::runtime_error("Cannot convert NULL to Decimal");
+        default: throw std::runtime_error("Invalid type conversion to Decimal");
+    }
+}
+
+// 结果集列元数据，由结果集的所有行共享
+class ResultSchema {
+public:
+    using Ptr = std::shared_ptr<const ResultSchema>;
+    static constexpr size_t npos = static_cast<size_t>(-1);
+    
+    struct ColumnInfo {
+        std::string name;
+        SQLSMALLINT sql_type = 0;
+        Value::Type type = Value::Type::Null;  // 列存储类型，Null表示尚未确定
     };
-    std::string str_val_;
+    
+    void add_column(const std::string& name, SQLSMALLINT sql_type, Value::Type type) {
+        // 同名列保留第一个，与按名称线性查找的行为一致
+        index_.emplace(name, columns_.size());
+        columns_.push_back(ColumnInfo{name, sql_type, type});
+    }
+    
+    size_t size() const { return columns_.size(); }
+    bool empty() const { return columns_.empty(); }
+    const ColumnInfo& column(size_t index) const { return columns_.at(index); }
+    
+    // 按名称查找列下标，不存在时返回npos
+    size_t find(const std::string& name) const {
+        auto it = index_.find(name);
+        return it == index_.end() ? npos : it->second;
+    }
+    
+    size_t index_of(const std::string& name) const {
+        size_t index = find(name);
+        if (index == npos) {
+            throw std::runtime_error("Column not found: " + name);
+        }
+        return index;
+    }
+    
+private:
+    std::vector<ColumnInfo> columns_;
+    std::unordered_map<std::string, size_t> index_;
 };
 
-// 结果集行
-class Row {
+// 单列数据，按类型连续存储，NULL记录在位图中
+class ColumnData {
 public:
-    Row() = default;
+    explicit ColumnData(Value::Type type = Value::Type::Null) : type_(type) {}
     
-    void add_column(const std::string& name, const Value& value) {
-        columns_.push_back(value);
-        column_names_.push_back(name);
+    Value::Type type() const { return type_; }
+    size_t size() const { return size_; }
+    
+    bool is_null(size_t row) const {
+        return (null_bits_[row / 64] >> (row % 64)) & 1;
     }
     
-    Value get(size_t index) const {
-        if (index >= columns_.size()) {
-            throw std::out_of_range("Column index out of range");
+    void reserve(size_t rows) {
+        null_bits_.reserve((rows + 63) / 64);
+        switch (type_) {
+            case Value::Type::Integer: ints_.reserve(rows); break;
+            case Value::Type::Long: longs_.reserve(rows); break;
+            case Value::Type::Double: doubles_.reserve(rows); break;
+            case Value::Type::Boolean: bools_.reserve(rows); break;
+            case Value::Type::String: string_offsets_.reserve(rows + 1); break;
+            case Value::Type::Timestamp:
+            case Value::Type::Date: timestamps_.reserve(rows); break;
+            case Value::Type::Decimal: decimals_.reserve(rows); break;
+            default: break;
+        }
+    }
+    
+    void clear() {
+        size_ = 0;
+        null_bits_.clear();
+        ints_.clear();
+        longs_.clear();
+        doubles_.clear();
+        bools_.clear();
+        string_data_.clear();
+        string_offsets_.assign(1, 0);
+        timestamps_.clear();
+        decimals_.clear();
+    }
+    
+    // 类型化追加，调用方保证与列类型一致
+    void append_null() {
+        switch (type_) {
+            case Value::Type::Integer: ints_.push_back(0); break;
+            case Value::Type::Long: longs_.push_back(0); break;
+            case Value::Type::Double: doubles_.push_back(0.0); break;
+            case Value::Type::Boolean: bools_.push_back(0); break;
+            case Value::Type::String: string_offsets_.push_back(string_data_.size()); break;
+            case Value::Type::Timestamp:
+            case Value::Type::Date: timestamps_.emplace_back(); break;
+            case Value::Type::Decimal: decimals_.emplace_back(); break;
+            default: break;
+        }
+        push_null_bit(true);
+    }
+    void append_int(SQLINTEGER v) { ints_.push_back(v); push_null_bit(false); }
+    void append_long(SQLBIGINT v) { longs_.push_back(v); push_null_bit(false); }
+    void append_double(double v) { doubles_.push_back(v); push_null_bit(false); }
+    void append_bool(bool v) { bools_.push_back(v ? 1 : 0); push_null_bit(false); }
+    void append_string(const char* data, size_t len) {
+        string_data_.insert(string_data_.end(), data, data + len);
+        string_offsets_.push_back(string_data_.size());
+        push_null_bit(false);
+    }
+    // 时间戳与日期列均以TIMESTAMP_STRUCT存储，日期列时间字段为0
+    void append_timestamp(const TIMESTAMP_STRUCT& v) {
+        timestamps_.push_back(v);
+        push_null_bit(false);
+    }
+    void append_date(const DATE_STRUCT& v) {
+        TIMESTAMP_STRUCT ts = {};
+        ts.year = v.year;
+        ts.month = v.month;
+        ts.day = v.day;
+        append_timestamp(ts);
+    }
+    void append_decimal(const Decimal& v) { decimals_.push_back(v); push_null_bit(false); }
+    
+    // 追加任意值，列类型未确定时采用第一个非空值的类型，类型不一致时转换为列类型
+    void append(const Value& value) {
+        if (value.is_null()) {
+            append_null();
+            return;
+        }
+        if (type_ == Value::Type::Null) {
+            adopt_type(value.type());
+        }
+        switch (type_) {
+            case Value::Type::Integer: append_int(static_cast<SQLINTEGER>(value.as<int>())); break;
+            case Value::Type::Long: append_long(value.as<long long>()); break;
+            case Value::Type::Double: append_double(value.as<double>()); break;
+            case Value::Type::Boolean: append_bool(value.as<bool>()); break;
+            case Value::Type::Timestamp:
+            case Value::Type::Date:
+                append_timestamp(value.as<TIMESTAMP_STRUCT>());
+                break;
+            case Value::Type::Decimal: append_decimal(value.as<Decimal>()); break;
+            default: {
+                if (value.type() == Value::Type::String) {
+                    std::string_view text = value.str();
+                    append_string(text.data(), text.size());
+                } else {
+                    std::string text = value.as<std::string>();
+                    append_string(text.data(), text.size());
+                }
+                break;
+            }
         }
-        return columns_[index];
     }
     
-    Value get(const std::string& name) const {
-        for (size_t i = 0; i < column_names_.size(); ++i) {
-            if (column_names_[i] == name) {
-                return columns_[i];
+    Value get(size_t row) const {
+        if (row >= size_) {
+            throw std::out_of_range("Row index out of range");
+        }
+        if (is_null(row)) {
+            return Value();
+        }
+        switch (type_) {
+            case Value::Type::Integer: return Value(ints_[row]);
+            case Value::Type::Long: return Value(longs_[row]);
+            case Value::Type::Double: return Value(doubles_[row]);
+            case Value::Type::Boolean: return Value(bools_[row] != 0);
+            case Value::Type::String: {
+                std::string_view s = string_at(row);
+                return Value(s.data(), s.size());
             }
+            case Value::Type::Timestamp: return Value(timestamps_[row]);
+            case Value::Type::Date: {
+                DATE_STRUCT date;
+                date.year = timestamps_[row].year;
+                date.month = timestamps_[row].month;
+                date.day = timestamps_[row].day;
+                return Value(date);
+            }
+            case Value::Type::Decimal: return Value(decimals_[row]);
+            default: return Value();
         }
-        throw std::runtime_error("Column not found: " + name);
     }
     
-    size_t size() const { return columns_.size(); }
-    bool empty() const { return columns_.empty(); }
+    // 按类型直接访问连续存储，NULL位置为默认值
+    const std::vector<SQLINTEGER>& int_values() const { return ints_; }
+    const std::vector<SQLBIGINT>& long_values() const { return longs_; }
+    const std::vector<double>& double_values() const { return doubles_; }
+    const std::vector<unsigned char>& bool_values() const { return bools_; }
+    const std::vector<TIMESTAMP_STRUCT>& timestamp_values() const { return timestamps_; }
+    const std::vector<Decimal>& decimal_values() const { return decimals_; }
+    
+    // 已分配的存储字节数(按容量计)
+    size_t memory_usage() const {
+        return null_bits_.capacity() * sizeof(uint64_t)
+             + ints_.capacity() * sizeof(SQLINTEGER)
+             + longs_.capacity() * sizeof(SQLBIGINT)
+             + doubles_.capacity() * sizeof(double)
+             + bools_.capacity()
+             + string_data_.capacity()
+             + string_offsets_.capacity() * sizeof(size_t)
+             + timestamps_.capacity() * sizeof(TIMESTAMP_STRUCT)
+             + decimals_.capacity() * sizeof(Decimal);
+    }
+    
+    // 字符串视图指向列内部存储，追加数据后失效
+    std::string_view string_at(size_t row) const {
+        if (row >= size_ || type_ != Value::Type::String) {
+            throw std::out_of_range("Row index out of range");
+        }
+        return std::string_view(string_data_.data() + string_offsets_[row],
+                                string_offsets_[row + 1] - string_offsets_[row]);
+    }
+    
+private:
+    void push_null_bit(bool null) {
+        if (size_ % 64 == 0) {
+            null_bits_.push_back(0);
+        }
+        if (null) {
+            null_bits_.back() |= uint64_t(1) << (size_ % 64);
+        }
+        ++size_;
+    }
+    
+    // 此前只有NULL，补齐新类型存储
+    void adopt_type(Value::Type type) {
+        type_ = type;
+        switch (type_) {
+            case Value::Type::Integer: ints_.resize(size_); break;
+            case Value::Type::Long: longs_.resize(size_); break;
+            case Value::Type::Double: doubles_.resize(size_); break;
+            case Value::Type::Boolean: bools_.resize(size_); break;
+            case Value::Type::Timestamp:
+            case Value::Type::Date: timestamps_.resize(size_); break;
+            case Value::Type::Decimal: decimals_.resize(size_); break;
+            default:
+                type_ = Value::Type::String;
+                string_offsets_.assign(size_ + 1, 0);
+                break;
+        }
+    }
+    
+    Value::Type type_;
+    size_t size_ = 0;
+    std::vector<uint64_t> null_bits_;
+    std::vector<SQLINTEGER> ints_;
+    std::vector<SQLBIGINT> longs_;
+    std::vector<double> doubles_;
+    std::vector<unsigned char> bools_;
+    // 字符串列共用一块连续缓冲区，第i行为[offsets[i], offsets[i+1])
+    std::vector<char> string_data_;
+    std::vector<size_t> string_offsets_ = std::vector<size_t>(1, 0);
+    std::vector<TIMESTAMP_STRUCT> timestamps_;
+    std::vector<Decimal> decimals_;
+};
+
+class ResultSet;
+
+// 结果集行，只是指向结果集某一行的轻量视图，不能比结果集存活更久
+class Row {
+public:
+    Row() = default;
+    Row(const ResultSet* rs, size_t index) : result_set_(rs), index_(index) {}
+    
+    inline Value get(size_t index) const;
+    inline Value get(const std::string& name) const;
+    inline bool is_null(size_t index) const;
+    
+    inline size_t size() const;
+    bool empty() const { return size() == 0; }
+    size_t index() const { return index_; }
     
     // 转换为目标类型
     template<typename T>
@@ -217,11 +934,11 @@ public:
     }
     
 private:
-    std::vector<Value> columns_;
-    std::vector<std::string> column_names_;
+    const ResultSet* result_set_ = nullptr;
+    size_t index_ = 0;
 };
 
-// 结果集
+// 结果集，按列存储，列元数据由schema共享
 class ResultSet {
 public:
     class Iterator {
@@ -229,23 +946,23 @@ public:
         using iterator_category = std::forward_iterator_tag;
         using value_type = Row;
         using difference_type = std::ptrdiff_t;
-        using pointer = Row*;
-        using reference = Row&;
+        using pointer = const Row*;
+        using reference = const Row&;
         
-        Iterator(ResultSet* rs, size_t index) 
-            : result_set_(rs), index_(index) {}
+        Iterator(const ResultSet* rs, size_t index) 
+            : result_set_(rs), index_(index), row_(rs, index) {}
         
-        reference operator*() { return (*result_set_)[index_]; }
-        pointer operator->() { return &(*result_set_)[index_]; }
+        reference operator*() const { return row_; }
+        pointer operator->() const { return &row_; }
         
         Iterator& operator++() {
-            ++index_;
+            row_ = Row(result_set_, ++index_);
             return *this;
         }
         
         Iterator operator++(int) {
             Iterator tmp = *this;
-            ++index_;
+            ++(*this);
             return tmp;
         }
         
@@ -258,49 +975,117 @@ public:
         }
         
     private:
-        ResultSet* result_set_;
+        const ResultSet* result_set_;
         size_t index_;
+        Row row_;
     };
     
-    ResultSet() = default;
+    ResultSet() : schema_(std::make_shared<ResultSchema>()) {}
     
-    void add_row(Row&& row) {
-        rows_.push_back(std::move(row));
+    explicit ResultSet(ResultSchema::Ptr schema)
+        : schema_(std::move(schema)) {
+        columns_.reserve(schema_->size());
+        for (size_t i = 0; i < schema_->size(); ++i) {
+            columns_.emplace_back(schema_->column(i).type);
+        }
     }
     
-    size_t size() const { return rows_.size(); }
-    bool empty() const { return rows_.empty(); }
+    const ResultSchema& schema() const { return *schema_; }
+    const ResultSchema::Ptr& schema_ptr() const { return schema_; }
     
-    Row& operator[](size_t index) {
-        if (index >= rows_.size()) {
-            throw std::out_of_range("Row index out of range");
-        }
-        return rows_[index];
-    }
+    size_t size() const { return row_count_; }
+    bool empty() const { return row_count_ == 0; }
+    size_t column_count() const { return columns_.size(); }
     
-    const Row& operator[](size_t index) const {
-        if (index >= rows_.size()) {
-            throw std::out_of_range("Row index out of range");
+    const ColumnData& column(size_t index) const {
+        if (index >= columns_.size()) {
+            throw std::out_of_range("Column index out of range");
         }
-        return rows_[index];
+        return columns_[index];
+    }
+    const ColumnData& column(const std::string& name) const {
+        return columns_[schema_->index_of(name)];
     }
     
-    Iterator begin() { return Iterator(this, 0); }
-    Iterator end() { return Iterator(this, rows_.size()); }
+    // 按列追加数据，所有列追加完一行后调用commit_rows
+    ColumnData& mutable_column(size_t index) { return columns_.at(index); }
+    void commit_rows(size_t rows) { row_count_ += rows; }
     
-    // 获取第一行第一列的值
-    template<typename T>
-    T scalar() const {
-        if (rows_.empty() || rows_[0].empty()) {
-            throw std::runtime_error("No data in result set");
+    // 追加一整行
+    void add_row(const std::vector<Value>& values) {
+        if (values.size() != columns_.size()) {
+            throw std::invalid_argument("Row width does not match result schema");
+        }
+        for (size_t i = 0; i < values.size(); ++i) {
+            columns_[i].append(values[i]);
         }
-        return rows_[0].get_as<T>(0);
+        ++row_count_;
+    }
+    
+    void reserve(size_t rows) {
+        for (auto& column : columns_) {
+            column.reserve(rows);
+        }
+    }
+    
+    // 清空数据但保留schema与已分配的容量
+    void clear() {
+        for (auto& column : columns_) {
+            column.clear();
+        }
+        row_count_ = 0;
+    }
+    
+    Row operator[](size_t index) const {
+        if (index >= row_count_) {
+            throw std::out_of_range("Row index out of range");
+        }
+        return Row(this, index);
+    }
+    
+    Iterator begin() const { return Iterator(this, 0); }
+    Iterator end() const { return Iterator(this, row_count_); }
+    
+    // 列数据占用的字节数，schema共享不计入
+    size_t memory_usage() const {
+        size_t bytes = sizeof(ResultSet) + columns_.capacity() * sizeof(ColumnData);
+        for (const auto& column : columns_) {
+            bytes += column.memory_usage();
+        }
+        return bytes;
+    }
+    
+    // 获取第一行第一列的值
+    template<typename T>
+    T scalar() const {
+        if (row_count_ == 0 || columns_.empty()) {
+            throw std::runtime_error("No data in result set");
+        }
+        return columns_[0].get(0).as<T>();
     }
     
 private:
-    std::vector<Row> rows_;
+    ResultSchema::Ptr schema_;
+    std::vector<ColumnData> columns_;
+    size_t row_count_ = 0;
 };
 
+inline Value Row::get(size_t index) const {
+    return result_set_->column(index).get(index_);
+}
+
+inline Value Row::get(const std::string& name) const {
+    return result_set_->column(name).get(index_);
+}
+
+inline bool Row::is_null(size_t index) const {
+    return result_set_->column(index).is_null(index_);
+}
+
+inline size_t Row::size() const {
+    return result_set_ ? result_set_->column_count() : 0;
+}
+
 /**
  * @brief 数据库类型枚举
  * 
@@ -353,6 +1138,10 @@ struct ConnectionConfig {
     unsigned int timeout = 30;  // 连接超时(秒)
     bool auto_commit = true;
     bool ssl = false;
+    bool driver_pooling = false;  // 未指定共享环境时，使用启用驱动管理器连接池的进程级环境
+    bool multi_statements = false;  // 允许一次发送多条语句(MySQL/MariaDB需显式开启)
+    size_t fetch_block_size = 256;  // 每次SQLFetch获取的行数(SQL_ATTR_ROW_ARRAY_SIZE)，1为逐行获取
+    size_t param_batch_size = 1000; // 批量执行时每次SQLExecute绑定的参数行数(SQL_ATTR_PARAMSET_SIZE)
     DatabaseType databaseType = DatabaseType::UNKNOWN;
     
     // 构建连接字符串
@@ -365,42 +1154,1003 @@ struct ConnectionConfig {
         if (!driver.empty()) {
             oss << "DRIVER={" << driver << "};";
         }
-        if (!host.empty()) {
-            oss << "SERVER=" << host << ";";
+        if (!host.empty()) {
+            oss << "SERVER=" << host << ";";
+        }
+        if (port > 0) {
+            oss << "PORT=" << port << ";";
+        }
+        if (!database.empty()) {
+            oss << "DATABASE=" << database << ";";
+        }
+        if (!username.empty()) {
+            oss << "UID=" << username << ";";
+        }
+        if (!password.empty()) {
+            oss << "PWD=" << password << ";";
+        }
+
+        // 添加可选参数
+        if (!charset.empty()) {
+            oss << "CHARSET=" << charset << ";";
+        }
+        if (timeout > 0) {
+            oss << "ConnectionTimeout=" << timeout << ";";
+        }
+        if (ssl) {
+            oss << "SSL Mode=REQUIRED;";
+        }
+        
+        // 数据库特定选项
+        if (databaseType == DatabaseType::MYSQL || databaseType == DatabaseType::MARIADB) {
+            // 1=FLAG_FIELD_LENGTH 2=FLAG_FOUND_ROWS，67108864=FLAG_MULTI_STATEMENTS
+            oss << "OPTION=" << (multi_statements ? 3 + 67108864 : 3) << ";";
+        } else if (databaseType == DatabaseType::POSTGRESQL) {
+            oss << "sslmode=require;";
+        }
+        
+        return oss.str();
+    }
+};
+
+// 按块获取结果集
+// 根据SQLDescribeCol的元数据为每列分配列式绑定缓冲区，一次SQLFetch取回一整块行。
+// 大对象或长度未知的列无法绑定，改为逐行SQLGetData并退化为单行获取。
+// 驱动支持SQL_GD_ANY_COLUMN时其余列照常绑定；否则只绑定第一个未绑定列之前的列。
+class BlockFetcher {
+public:
+    // 单列可绑定的最大字节数，超过则逐行SQLGetData
+    static constexpr SQLLEN kMaxBoundColumnBytes = 4096;
+    // 单块所有绑定缓冲区的总字节上限
+    static constexpr size_t kMaxBlockBytes = 8 * 1024 * 1024;
+    
+    struct Column {
+        std::string name;
+        SQLSMALLINT sql_type = 0;
+        SQLULEN column_size = 0;
+        SQLSMALLINT decimal_digits = 0;
+        SQLSMALLINT c_type = SQL_C_CHAR;
+        SQLLEN width = 0;               // 单元宽度(字节)
+        bool bound = false;             // false表示逐行SQLGetData
+        std::vector<char> data;         // width * 行数
+        std::vector<SQLLEN> indicators;
+        std::string long_value;         // 未绑定字符列的当前值
+    };
+    
+    // c_types非空时按给定C类型绑定各列（编译期类型解码使用），否则按SQL类型选择
+    // any_column_getdata为驱动是否支持SQL_GD_ANY_COLUMN
+    BlockFetcher(SQLHSTMT stmt, size_t block_size,
+                 const std::vector<SQLSMALLINT>& c_types = {},
+                 bool any_column_getdata = false)
+        : stmt_(stmt) {
+        SQLSMALLINT column_count = 0;
+        SQLNumResultCols(stmt_, &column_count);
+        if (column_count <= 0) {
+            return;
+        }
+        if (!c_types.empty() && c_types.size() != static_cast<size_t>(column_count)) {
+            throw std::runtime_error("Result has " + std::to_string(column_count)
+                                     + " columns, expected " + std::to_string(c_types.size()));
+        }
+        
+        columns_.resize(column_count);
+        auto schema = std::make_shared<ResultSchema>();
+        schema_ = schema;
+        size_t row_bytes = 0;
+        bool bindable = true;       // 所有列均已绑定
+        
+        for (SQLSMALLINT i = 1; i <= column_count; ++i) {
+            Column& col = columns_[i - 1];
+            SQLCHAR column_name[256];
+            SQLSMALLINT name_len = 0;
+            SQLSMALLINT nullable = 0;
+            
+            SQLDescribeCol(stmt_, i, column_name, sizeof(column_name),
+                          &name_len, &col.sql_type, &col.column_size, 
+                          &col.decimal_digits, &nullable);
+            col.name = reinterpret_cast<char*>(column_name);
+            
+            plan_column(col);
+            if (!c_types.empty() && c_types[i - 1] != col.c_type) {
+                override_c_type(col, c_types[i - 1]);
+            }
+            schema->add_column(col.name, col.sql_type, value_type(col));
+            // 不支持SQL_GD_ANY_COLUMN时，第一个无法绑定的列之后全部逐行获取
+            bool fits = col.width > 0 && col.width <= kMaxBoundColumnBytes;
+            col.bound = fits && (bindable || any_column_getdata);
+            if (!fits) {
+                bindable = false;
+            }
+            if (col.bound) {
+                row_bytes += col.width + sizeof(SQLLEN);
+            }
+        }
+        
+        // 存在逐行获取的列时退化为单行获取
+        rows_per_block_ = std::max<size_t>(1, block_size);
+        if (!bindable) {
+            rows_per_block_ = 1;
+        } else if (row_bytes > 0) {
+            rows_per_block_ = std::min(rows_per_block_,
+                                       std::max<size_t>(1, kMaxBlockBytes / row_bytes));
+        }
+        
+        for (SQLSMALLINT i = 1; i <= column_count; ++i) {
+            Column& col = columns_[i - 1];
+            size_t rows = col.bound ? rows_per_block_ : 1;
+            col.data.resize(std::max<SQLLEN>(col.width, 1) * rows);
+            col.indicators.resize(rows, 0);
+            
+            if (col.bound) {
+                check(SQLBindCol(stmt_, i, col.c_type, col.data.data(), col.width,
+                                 col.indicators.data()),
+                      "Bind result column");
+            }
+        }
+        
+        row_status_.resize(rows_per_block_);
+        check(SQLSetStmtAttr(stmt_, SQL_ATTR_ROW_BIND_TYPE,
+                             (SQLPOINTER)SQL_BIND_BY_COLUMN, 0),
+              "Set row bind type");
+        check(SQLSetStmtAttr(stmt_, SQL_ATTR_ROW_ARRAY_SIZE,
+                             (SQLPOINTER)rows_per_block_, 0),
+              "Set row array size");
+        SQLSetStmtAttr(stmt_, SQL_ATTR_ROW_STATUS_PTR, row_status_.data(), 0);
+        SQLSetStmtAttr(stmt_, SQL_ATTR_ROWS_FETCHED_PTR, &rows_fetched_, 0);
+    }
+    
+    ~BlockFetcher() {
+        if (columns_.empty()) {
+            return;
+        }
+        // 恢复语句状态，避免语句句柄复用时指向已释放的缓冲区
+        SQLFreeStmt(stmt_, SQL_UNBIND);
+        SQLSetStmtAttr(stmt_, SQL_ATTR_ROW_ARRAY_SIZE, (SQLPOINTER)1, 0);
+        SQLSetStmtAttr(stmt_, SQL_ATTR_ROW_STATUS_PTR, nullptr, 0);
+        SQLSetStmtAttr(stmt_, SQL_ATTR_ROWS_FETCHED_PTR, nullptr, 0);
+    }
+    
+    BlockFetcher(const BlockFetcher&) = delete;
+    BlockFetcher& operator=(const BlockFetcher&) = delete;
+    
+    size_t column_count() const { return columns_.size(); }
+    const std::vector<Column>& columns() const { return columns_; }
+    size_t rows_per_block() const { return rows_per_block_; }
+    
+    // 结果集列元数据，无结果集时为空
+    const ResultSchema::Ptr& schema() const { return schema_; }
+    
+    // 获取下一块，返回本块行数，0表示没有更多数据
+    size_t fetch_block() {
+        if (columns_.empty()) {
+            return 0;
+        }
+        
+        rows_fetched_ = 0;
+        SQLRETURN ret = SQLFetch(stmt_);
+        if (ret == SQL_NO_DATA) {
+            return 0;
+        }
+        check(ret, "Fetch rows");
+        
+        // 单行获取时由驱动填写的行数可能缺失
+        size_t rows = rows_per_block_ == 1 ? 1 : static_cast<size_t>(rows_fetched_);
+        
+        for (size_t i = 0; i < columns_.size(); ++i) {
+            if (!columns_[i].bound) {
+                get_unbound(static_cast<SQLUSMALLINT>(i + 1), columns_[i]);
+            }
+        }
+        return rows;
+    }
+    
+    // 块内第row行是否有效（驱动可能标记出错的行）
+    bool row_ok(size_t row) const {
+        return row_status_[row] != SQL_ROW_ERROR && row_status_[row] != SQL_ROW_NOROW;
+    }
+    
+    bool is_null(size_t row, size_t col) const {
+        const Column& c = columns_[col];
+        return c.indicators[c.bound ? row : 0] == SQL_NULL_DATA;
+    }
+    
+    SQLLEN indicator(size_t row, size_t col) const {
+        const Column& c = columns_[col];
+        return c.indicators[c.bound ? row : 0];
+    }
+    
+    // 定长单元的原始数据
+    const char* cell(size_t row, size_t col) const {
+        const Column& c = columns_[col];
+        return c.data.data() + (c.bound ? row : 0) * c.width;
+    }
+    
+    // 字符列文本，已处理截断与逐行获取的列
+    std::string text(size_t row, size_t col) const {
+        const Column& c = columns_[col];
+        if (!c.bound) {
+            return c.long_value;
+        }
+        const char* data = cell(row, col);
+        return std::string(data, text_length(c, data, c.indicators[row]));
+    }
+    
+    // 解码块内第row行第col列
+    Value value(size_t row, size_t col) const {
+        const Column& c = columns_[col];
+        if (!c.bound) {
+            row = 0;
+        }
+        SQLLEN indicator = c.indicators[row];
+        if (indicator == SQL_NULL_DATA) {
+            return Value();
+        }
+        const char* cell = c.data.data() + row * c.width;
+        
+        switch (c.c_type) {
+            case SQL_C_SLONG: {
+                SQLINTEGER v;
+                std::memcpy(&v, cell, sizeof(v));
+                return Value(v);
+            }
+            case SQL_C_SBIGINT: {
+                SQLBIGINT v;
+                std::memcpy(&v, cell, sizeof(v));
+                return Value(v);
+            }
+            case SQL_C_DOUBLE: {
+                double v;
+                std::memcpy(&v, cell, sizeof(v));
+                return Value(v);
+            }
+            case SQL_C_BIT:
+                return Value(*cell != 0);
+            case SQL_C_TYPE_DATE: {
+                DATE_STRUCT date_val;
+                std::memcpy(&date_val, cell, sizeof(date_val));
+                return Value(date_val);
+            }
+            case SQL_C_TYPE_TIMESTAMP: {
+                TIMESTAMP_STRUCT ts_val;
+                std::memcpy(&ts_val, cell, sizeof(ts_val));
+                return Value(ts_val);
+            }
+            default: {
+                if (value_type(c) == Value::Type::Decimal) {
+                    if (!c.bound) {
+                        return Value(Decimal::parse(c.long_value.data(), c.long_value.size()));
+                    }
+                    return Value(Decimal::parse(cell, text_length(c, cell, indicator)));
+                }
+                // 直接从绑定缓冲区构造，短字符串不分配
+                if (!c.bound) {
+                    return Value(c.long_value);
+                }
+                return Value(cell, text_length(c, cell, indicator));
+            }
+        }
+    }
+    
+    // 将当前块按列解码追加到结果集，跳过驱动标记为出错的行
+    void append_block(ResultSet& result_set, size_t rows) const {
+        size_t valid_rows = 0;
+        for (size_t r = 0; r < rows; ++r) {
+            if (row_ok(r)) {
+                ++valid_rows;
+            }
+        }
+        
+        for (size_t c = 0; c < columns_.size(); ++c) {
+            const Column& col = columns_[c];
+            ColumnData& out = result_set.mutable_column(c);
+            
+            for (size_t r = 0; r < rows; ++r) {
+                if (valid_rows != rows && !row_ok(r)) {
+                    continue;
+                }
+                size_t slot = col.bound ? r : 0;
+                SQLLEN indicator = col.indicators[slot];
+                if (indicator == SQL_NULL_DATA) {
+                    out.append_null();
+                    continue;
+                }
+                const char* cell = col.data.data() + slot * col.width;
+                
+                switch (col.c_type) {
+                    case SQL_C_SLONG: {
+                        SQLINTEGER v;
+                        std::memcpy(&v, cell, sizeof(v));
+                        out.append_int(v);
+                        break;
+                    }
+                    case SQL_C_SBIGINT: {
+                        SQLBIGINT v;
+                        std::memcpy(&v, cell, sizeof(v));
+                        out.append_long(v);
+                        break;
+                    }
+                    case SQL_C_DOUBLE: {
+                        double v;
+                        std::memcpy(&v, cell, sizeof(v));
+                        out.append_double(v);
+                        break;
+                    }
+                    case SQL_C_BIT:
+                        out.append_bool(*cell != 0);
+                        break;
+                    case SQL_C_TYPE_DATE: {
+                        DATE_STRUCT v;
+                        std::memcpy(&v, cell, sizeof(v));
+                        out.append_date(v);
+                        break;
+                    }
+                    case SQL_C_TYPE_TIMESTAMP: {
+                        TIMESTAMP_STRUCT v;
+                        std::memcpy(&v, cell, sizeof(v));
+                        out.append_timestamp(v);
+                        break;
+                    }
+                    case SQL_C_CHAR:
+                        if (out.type() == Value::Type::Decimal) {
+                            out.append_decimal(col.bound
+                                ? Decimal::parse(cell, text_length(col, cell, indicator))
+                                : Decimal::parse(col.long_value.data(), col.long_value.size()));
+                            break;
+                        }
+                        // 字符列直接写入列的字符串缓冲区
+                        if (out.type() == Value::Type::String) {
+                            if (col.bound) {
+                                out.append_string(cell, text_length(col, cell, indicator));
+                            } else {
+                                out.append_string(col.long_value.data(), col.long_value.size());
+                            }
+                            break;
+                        }
+                        out.append(value(r, c));
+                        break;
+                    default:
+                        out.append(value(r, c));
+                        break;
+                }
+            }
+        }
+        result_set.commit_rows(valid_rows);
+    }
+    
+private:
+    // 根据SQL类型选择C类型与单元宽度，width为0表示长度未知
+    static void plan_column(Column& col) {
+        switch (col.sql_type) {
+            case SQL_INTEGER:
+            case SQL_SMALLINT:
+            case SQL_TINYINT:
+                col.c_type = SQL_C_SLONG;
+                col.width = sizeof(SQLINTEGER);
+                break;
+            case SQL_BIGINT:
+                col.c_type = SQL_C_SBIGINT;
+                col.width = sizeof(SQLBIGINT);
+                break;
+            case SQL_DOUBLE:
+            case SQL_FLOAT:
+            case SQL_REAL:
+                col.c_type = SQL_C_DOUBLE;
+                col.width = sizeof(double);
+                break;
+            case SQL_BIT:
+                col.c_type = SQL_C_BIT;
+                col.width = sizeof(unsigned char);
+                break;
+            case SQL_DATE:
+            case SQL_TYPE_DATE:
+                col.c_type = SQL_C_TYPE_DATE;
+                col.width = sizeof(DATE_STRUCT);
+                break;
+            case SQL_TIMESTAMP:
+            case SQL_TYPE_TIMESTAMP:
+                col.c_type = SQL_C_TYPE_TIMESTAMP;
+                col.width = sizeof(TIMESTAMP_STRUCT);
+                break;
+            case SQL_DECIMAL:
+            case SQL_NUMERIC:
+                // 精度+符号+小数点+结束符
+                col.c_type = SQL_C_CHAR;
+                col.width = col.column_size > 0 ? col.column_size + 3 : 0;
+                break;
+            case SQL_LONGVARCHAR:
+            case SQL_WLONGVARCHAR:
+            case SQL_LONGVARBINARY:
+                col.c_type = SQL_C_CHAR;
+                col.width = 0;
+                break;
+            default:
+                // 按UTF-8每字符最多4字节估算
+                col.c_type = SQL_C_CHAR;
+                col.width = col.column_size > 0
+                    ? static_cast<SQLLEN>(std::min<SQLULEN>(col.column_size,
+                                                           kMaxBoundColumnBytes)) * 4 + 1
+                    : 0;
+                break;
+        }
+    }
+    
+    // 使用调用方指定的C类型
+    static void override_c_type(Column& col, SQLSMALLINT c_type) {
+        bool was_text = col.c_type == SQL_C_CHAR;
+        col.c_type = c_type;
+        switch (c_type) {
+            case SQL_C_SLONG: col.width = sizeof(SQLINTEGER); break;
+            case SQL_C_SBIGINT: col.width = sizeof(SQLBIGINT); break;
+            case SQL_C_DOUBLE: col.width = sizeof(double); break;
+            case SQL_C_BIT: col.width = sizeof(unsigned char); break;
+            case SQL_C_TYPE_DATE: col.width = sizeof(DATE_STRUCT); break;
+            case SQL_C_TYPE_TIMESTAMP: col.width = sizeof(TIMESTAMP_STRUCT); break;
+            default:
+                // 定长列原先按二进制宽度规划，转为文本时按显示宽度重新计算
+                if (!was_text) {
+                    col.width = display_width(col);
+                }
+                // 非字符列转为文本时长度有限
+                if (col.width == 0 && col.sql_type != SQL_LONGVARCHAR
+                    && col.sql_type != SQL_WLONGVARCHAR && col.sql_type != SQL_LONGVARBINARY) {
+                    col.width = 64;
+                }
+                col.c_type = SQL_C_CHAR;
+                break;
+        }
+    }
+    
+    // 列以文本获取时的单元宽度(含结束符)，0表示长度未知
+    static SQLLEN display_width(const Column& col) {
+        switch (col.sql_type) {
+            case SQL_TINYINT: return 5;        // -128
+            case SQL_SMALLINT: return 7;       // -32768
+            case SQL_INTEGER: return 12;       // -2147483648
+            case SQL_BIGINT: return 21;        // -9223372036854775808
+            case SQL_REAL: return 15;
+            case SQL_DOUBLE:
+            case SQL_FLOAT: return 25;
+            case SQL_BIT: return 2;
+            case SQL_DATE:
+            case SQL_TYPE_DATE: return 11;     // yyyy-mm-dd
+            case SQL_TIMESTAMP:
+            case SQL_TYPE_TIMESTAMP:
+                // yyyy-mm-dd hh:mm:ss[.fffffffff]
+                return static_cast<SQLLEN>(std::max<SQLULEN>(col.column_size, 29)) + 1;
+            default:
+                return col.column_size > 0
+                    ? static_cast<SQLLEN>(std::min<SQLULEN>(col.column_size,
+                                                           kMaxBoundColumnBytes)) + 3
+                    : 0;
+        }
+    }
+    
+    // 列在结果集中的存储类型
+    static Value::Type value_type(const Column& col) {
+        switch (col.c_type) {
+            case SQL_C_SLONG: return Value::Type::Integer;
+            case SQL_C_SBIGINT: return Value::Type::Long;
+            case SQL_C_DOUBLE: return Value::Type::Double;
+            case SQL_C_BIT: return Value::Type::Boolean;
+            case SQL_C_TYPE_DATE: return Value::Type::Date;
+            case SQL_C_TYPE_TIMESTAMP: return Value::Type::Timestamp;
+            default:
+                // 超过18位精度的定点数保留原始文本
+                if ((col.sql_type == SQL_DECIMAL || col.sql_type == SQL_NUMERIC)
+                    && col.column_size > 0 && col.column_size <= Decimal::kMaxDigits) {
+                    return Value::Type::Decimal;
+                }
+                return Value::Type::String;
+        }
+    }
+    
+    // cell为该行的单元起始地址，长度未知或被截断时按单元内的结束符计算
+    static size_t text_length(const Column& c, const char* cell, SQLLEN indicator) {
+        if (indicator == SQL_NO_TOTAL || indicator >= c.width) {
+            return ::strnlen(cell, c.width - 1);
+        }
+        return static_cast<size_t>(indicator);
+    }
+    
+    // 逐行读取未绑定列，分段读取任意长度的字符数据
+    void get_unbound(SQLUSMALLINT index, Column& col) {
+        if (col.c_type != SQL_C_CHAR) {
+            check(SQLGetData(stmt_, index, col.c_type, col.data.data(), col.width,
+                             &col.indicators[0]),
+                  "Get column data");
+            return;
+        }
+        
+        col.long_value.clear();
+        char chunk[4096];
+        while (true) {
+            SQLLEN indicator = 0;
+            SQLRETURN ret = SQLGetData(stmt_, index, SQL_C_CHAR, chunk,
+                                       sizeof(chunk), &indicator);
+            if (ret == SQL_NO_DATA) {
+                break;
+            }
+            check(ret, "Get column data");
+            if (indicator == SQL_NULL_DATA) {
+                col.indicators[0] = SQL_NULL_DATA;
+                return;
+            }
+            
+            // 截断时缓冲区被填满（不含结束符）
+            size_t piece = (indicator == SQL_NO_TOTAL || indicator >= (SQLLEN)sizeof(chunk))
+                               ? sizeof(chunk) - 1
+                               : static_cast<size_t>(indicator);
+            col.long_value.append(chunk, piece);
+            if (ret == SQL_SUCCESS) {
+                break;
+            }
+        }
+        col.indicators[0] = static_cast<SQLLEN>(col.long_value.size());
+    }
+    
+    void check(SQLRETURN ret, const std::string& operation) const {
+        if (!SQL_SUCCEEDED(ret)) {
+            throw OdbcException("ODBC operation failed: " + operation,
+                               SQL_HANDLE_STMT, stmt_);
+        }
+    }
+    
+    SQLHSTMT stmt_;
+    std::vector<Column> columns_;
+    ResultSchema::Ptr schema_ = std::make_shared<ResultSchema>();
+    size_t rows_per_block_ = 1;
+    SQLULEN rows_fetched_ = 0;
+    std::vector<SQLUSMALLINT> row_status_;
+};
+
+// 编译期列类型映射
+// ColumnTraits<T>给出C++类型T对应的ODBC C类型、可接受的SQL类型以及从绑定缓冲区解码的方法
+inline bool is_numeric_sql_type(SQLSMALLINT t) {
+    switch (t) {
+        case SQL_INTEGER: case SQL_SMALLINT: case SQL_TINYINT: case SQL_BIGINT:
+        case SQL_DOUBLE: case SQL_FLOAT: case SQL_REAL:
+        case SQL_DECIMAL: case SQL_NUMERIC: case SQL_BIT:
+            return true;
+        default:
+            return false;
+    }
+}
+
+inline bool is_datetime_sql_type(SQLSMALLINT t) {
+    return t == SQL_DATE || t == SQL_TYPE_DATE || t == SQL_TIMESTAMP || t == SQL_TYPE_TIMESTAMP;
+}
+
+template<typename T, typename Enable = void>
+struct ColumnTraits;
+
+template<typename T>
+struct ColumnTraits<T, typename std::enable_if<std::is_integral<T>::value
+                                               && !std::is_same<T, bool>::value>::type> {
+    // 32位无符号整数可能超出SQLINTEGER范围
+    static constexpr bool kNarrow = sizeof(T) < sizeof(SQLINTEGER)
+        || (sizeof(T) == sizeof(SQLINTEGER) && std::is_signed<T>::value);
+    static constexpr SQLSMALLINT c_type = kNarrow ? SQL_C_SLONG : SQL_C_SBIGINT;
+    static bool accepts(SQLSMALLINT sql_type) { return is_numeric_sql_type(sql_type); }
+    static T decode(const BlockFetcher& f, size_t row, size_t col) {
+        if (kNarrow) {
+            SQLINTEGER v;
+            std::memcpy(&v, f.cell(row, col), sizeof(v));
+            return static_cast<T>(v);
+        }
+        SQLBIGINT v;
+        std::memcpy(&v, f.cell(row, col), sizeof(v));
+        return static_cast<T>(v);
+    }
+};
+
+template<typename T>
+struct ColumnTraits<T, typename std::enable_if<std::is_floating_point<T>::value>::type> {
+    static constexpr SQLSMALLINT c_type = SQL_C_DOUBLE;
+    static bool accepts(SQLSMALLINT sql_type) { return is_numeric_sql_type(sql_type); }
+    static T decode(const BlockFetcher& f, size_t row, size_t col) {
+        double v;
+        std::memcpy(&v, f.cell(row, col), sizeof(v));
+        return static_cast<T>(v);
+    }
+};
+
+template<>
+struct ColumnTraits<bool> {
+    static constexpr SQLSMALLINT c_type = SQL_C_BIT;
+    static bool accepts(SQLSMALLINT sql_type) { return is_numeric_sql_type(sql_type); }
+    static bool decode(const BlockFetcher& f, size_t row, size_t col) {
+        return *f.cell(row, col) != 0;
+    }
+};
+
+template<>
+struct ColumnTraits<std::string> {
+    static constexpr SQLSMALLINT c_type = SQL_C_CHAR;
+    static bool accepts(SQLSMALLINT) { return true; }
+    static std::string decode(const BlockFetcher& f, size_t row, size_t col) {
+        return f.text(row, col);
+    }
+};
+
+template<>
+struct ColumnTraits<TIMESTAMP_STRUCT> {
+    static constexpr SQLSMALLINT c_type = SQL_C_TYPE_TIMESTAMP;
+    static bool accepts(SQLSMALLINT sql_type) { return is_datetime_sql_type(sql_type); }
+    static TIMESTAMP_STRUCT decode(const BlockFetcher& f, size_t row, size_t col) {
+        TIMESTAMP_STRUCT v;
+        std::memcpy(&v, f.cell(row, col), sizeof(v));
+        return v;
+    }
+};
+
+template<>
+struct ColumnTraits<DATE_STRUCT> {
+    static constexpr SQLSMALLINT c_type = SQL_C_TYPE_DATE;
+    static bool accepts(SQLSMALLINT sql_type) { return is_datetime_sql_type(sql_type); }
+    static DATE_STRUCT decode(const BlockFetcher& f, size_t row, size_t col) {
+        DATE_STRUCT v;
+        std::memcpy(&v, f.cell(row, col), sizeof(v));
+        return v;
+    }
+};
+
+template<>
+struct ColumnTraits<Decimal> {
+    static constexpr SQLSMALLINT c_type = SQL_C_CHAR;
+    static bool accepts(SQLSMALLINT sql_type) { return is_numeric_sql_type(sql_type); }
+    static Decimal decode(const BlockFetcher& f, size_t row, size_t col) {
+        std::string text = f.text(row, col);
+        return Decimal::parse(text.data(), text.size());
+    }
+};
+
+// 可为NULL的列
+template<typename T>
+struct ColumnTraits<std::optional<T>> {
+    static constexpr SQLSMALLINT c_type = ColumnTraits<T>::c_type;
+    static bool accepts(SQLSMALLINT sql_type) { return ColumnTraits<T>::accepts(sql_type); }
+    static std::optional<T> decode(const BlockFetcher& f, size_t row, size_t col) {
+        return ColumnTraits<T>::decode(f, row, col);
+    }
+};
+
+// 结构体映射，使用方为自己的类型特化：
+//   template<> struct RowMapper<User> {
+//       using tuple_type = std::tuple<int64_t, std::string>;
+//       static User from_tuple(tuple_type&& t);
+//   };
+template<typename T>
+struct RowMapper;
+
+template<typename... Ts>
+struct RowMapper<std::tuple<Ts...>> {
+    using tuple_type = std::tuple<Ts...>;
+    static tuple_type from_tuple(tuple_type&& t) { return std::move(t); }
+};
+
+// 按元组类型解码结果集
+template<typename Tuple>
+class TypedRowDecoder {
+public:
+    static constexpr size_t kColumns = std::tuple_size<Tuple>::value;
+    
+    // 绑定前需要的各列C类型
+    static std::vector<SQLSMALLINT> c_types() {
+        return c_types_impl(std::make_index_sequence<kColumns>());
+    }
+    
+    // 语句执行后检查一次列类型
+    static void check_columns(const BlockFetcher& fetcher) {
+        check_impl(fetcher, std::make_index_sequence<kColumns>());
+    }
+    
+    static Tuple decode(const BlockFetcher& fetcher, size_t row) {
+        return decode_impl(fetcher, row, std::make_index_sequence<kColumns>());
+    }
+    
+private:
+    template<typename T>
+    struct is_optional : std::false_type {};
+    template<typename T>
+    struct is_optional<std::optional<T>> : std::true_type {};
+    
+    template<size_t... I>
+    static std::vector<SQLSMALLINT> c_types_impl(std::index_sequence<I...>) {
+        return {ColumnTraits<typename std::tuple_element<I, Tuple>::type>::c_type...};
+    }
+    
+    template<size_t... I>
+    static void check_impl(const BlockFetcher& fetcher, std::index_sequence<I...>) {
+        int expand[] = {0, (check_column<I>(fetcher), 0)...};
+        (void)expand;
+    }
+    
+    template<size_t I>
+    static void check_column(const BlockFetcher& fetcher) {
+        using T = typename std::tuple_element<I, Tuple>::type;
+        const auto& col = fetcher.columns()[I];
+        if (!ColumnTraits<T>::accepts(col.sql_type)) {
+            throw std::runtime_error("Column " + col.name + " has SQL type "
+                                     + std::to_string(col.sql_type)
+                                     + " incompatible with requested C++ type");
+        }
+    }
+    
+    template<size_t... I>
+    static Tuple decode_impl(const BlockFetcher& fetcher, size_t row, std::index_sequence<I...>) {
+        return Tuple(decode_column<I>(fetcher, row)...);
+    }
+    
+    template<size_t I>
+    static typename std::tuple_element<I, Tuple>::type
+    decode_column(const BlockFetcher& fetcher, size_t row) {
+        using T = typename std::tuple_element<I, Tuple>::type;
+        if (fetcher.indicator(row, I) == SQL_NULL_DATA) {
+            return null_value<T>(fetcher.columns()[I].name);
+        }
+        return ColumnTraits<T>::decode(fetcher, row, I);
+    }
+    
+    template<typename T>
+    static typename std::enable_if<is_optional<T>::value, T>::type
+    null_value(const std::string&) { return T(); }
+    
+    template<typename T>
+    static typename std::enable_if<!is_optional<T>::value, T>::type
+    null_value(const std::string& name) {
+        throw std::runtime_error("NULL value in non-optional column " + name);
+    }
+};
+
+// 批量执行的列式参数
+// 每列保存定长单元与长度/指示数组，供SQL_ATTR_PARAMSET_SIZE数组绑定使用
+class ParamBatch {
+public:
+    struct Column {
+        SQLSMALLINT c_type = SQL_C_CHAR;
+        SQLSMALLINT sql_type = SQL_VARCHAR;
+        SQLLEN width = 0;                 // 单元宽度(字节)
+        std::vector<char> data;           // width * 行数
+        std::vector<SQLLEN> indicators;   // 长度或SQL_NULL_DATA
+    };
+    
+    ParamBatch() = default;
+    
+    size_t rows() const { return rows_; }
+    size_t column_count() const { return columns_.size(); }
+    const std::vector<Column>& columns() const { return columns_; }
+    
+    // 按参数顺序追加一列；nulls非空时为true的行绑定为NULL
+    ParamBatch& add(const std::vector<int>& values, const std::vector<bool>& nulls = {}) {
+        return add_fixed<SQLINTEGER>(values, nulls, SQL_C_SLONG, SQL_INTEGER);
+    }
+    ParamBatch& add(const std::vector<long long>& values, const std::vector<bool>& nulls = {}) {
+        return add_fixed<SQLBIGINT>(values, nulls, SQL_C_SBIGINT, SQL_BIGINT);
+    }
+    ParamBatch& add(const std::vector<double>& values, const std::vector<bool>& nulls = {}) {
+        return add_fixed<double>(values, nulls, SQL_C_DOUBLE, SQL_DOUBLE);
+    }
+    ParamBatch& add(const std::vector<std::string>& values, const std::vector<bool>& nulls = {}) {
+        check_rows(values.size(), nulls);
+        Column col;
+        col.c_type = SQL_C_CHAR;
+        col.sql_type = SQL_VARCHAR;
+        
+        size_t max_len = 0;
+        for (const auto& v : values) {
+            max_len = std::max(max_len, v.size());
+        }
+        col.width = static_cast<SQLLEN>(max_len + 1);
+        col.data.assign(col.width * values.size(), '\0');
+        col.indicators.resize(values.size());
+        
+        for (size_t i = 0; i < values.size(); ++i) {
+            if (!nulls.empty() && nulls[i]) {
+                col.indicators[i] = SQL_NULL_DATA;
+                continue;
+            }
+            std::memcpy(col.data.data() + i * col.width, values[i].data(), values[i].size());
+            col.indicators[i] = static_cast<SQLLEN>(values[i].size());
+        }
+        columns_.push_back(std::move(col));
+        return *this;
+    }
+    
+    // 由行式元组构建，每个元组元素对应一个参数
+    template<typename... Ts>
+    static ParamBatch from_rows(const std::vector<std::tuple<Ts...>>& rows) {
+        ParamBatch batch;
+        batch.add_tuple_columns(rows, std::index_sequence_for<Ts...>());
+        return batch;
+    }
+    
+private:
+    void check_rows(size_t count, const std::vector<bool>& nulls) {
+        if (!columns_.empty() && count != rows_) {
+            throw std::invalid_argument("Batch columns must have the same number of rows");
         }
-        if (port > 0) {
-            oss << "PORT=" << port << ";";
+        if (!nulls.empty() && nulls.size() != count) {
+            throw std::invalid_argument("Null mask size does not match batch column");
         }
-        if (!database.empty()) {
-            oss << "DATABASE=" << database << ";";
+        rows_ = count;
+    }
+    
+    template<typename Stored, typename T>
+    ParamBatch& add_fixed(const std::vector<T>& values, const std::vector<bool>& nulls,
+                          SQLSMALLINT c_type, SQLSMALLINT sql_type) {
+        check_rows(values.size(), nulls);
+        Column col;
+        col.c_type = c_type;
+        col.sql_type = sql_type;
+        col.width = sizeof(Stored);
+        col.data.resize(col.width * values.size());
+        col.indicators.resize(values.size(), 0);
+        
+        for (size_t i = 0; i < values.size(); ++i) {
+            if (!nulls.empty() && nulls[i]) {
+                col.indicators[i] = SQL_NULL_DATA;
+                continue;
+            }
+            Stored v = static_cast<Stored>(values[i]);
+            std::memcpy(col.data.data() + i * col.width, &v, sizeof(v));
         }
-        if (!username.empty()) {
-            oss << "UID=" << username << ";";
+        columns_.push_back(std::move(col));
+        return *this;
+    }
+    
+    template<typename Tuple, size_t... I>
+    void add_tuple_columns(const std::vector<Tuple>& rows, std::index_sequence<I...>) {
+        int expand[] = {0, (add_tuple_column<I>(rows), 0)...};
+        (void)expand;
+    }
+    
+    template<size_t I, typename Tuple>
+    void add_tuple_column(const std::vector<Tuple>& rows) {
+        using T = typename std::decay<typename std::tuple_element<I, Tuple>::type>::type;
+        std::vector<T> column;
+        column.reserve(rows.size());
+        for (const auto& row : rows) {
+            column.push_back(std::get<I>(row));
         }
-        if (!password.empty()) {
-            oss << "PWD=" << password << ";";
+        add(column);
+    }
+    
+    std::vector<Column> columns_;
+    size_t rows_ = 0;
+};
+
+// 批量执行结果
+struct BatchResult {
+    size_t rows_processed = 0;             ///< 驱动已处理的参数行数
+    size_t rows_affected = 0;              ///< 各分块SQLRowCount之和
+    std::vector<SQLUSMALLINT> row_status;  ///< 每行状态(SQL_PARAM_SUCCESS/SQL_PARAM_ERROR等)
+    
+    size_t error_count() const {
+        return static_cast<size_t>(std::count(row_status.begin(), row_status.end(),
+                                              static_cast<SQLUSMALLINT>(SQL_PARAM_ERROR)));
+    }
+};
+
+// 多语句批次中一条语句的结果
+struct StatementResult {
+    bool has_result_set = false;  ///< 为true时result有效，否则affected_rows有效
+    ResultSet result;
+    size_t affected_rows = 0;
+};
+
+// 只进游标
+// 持有已执行的语句句柄，按批获取结果，批内存在下一批时复用，内存占用只与批大小相关。
+// 游标不能比创建它的连接存活更久；多数驱动在游标关闭前不允许该连接执行其他语句。
+class Cursor {
+public:
+    Cursor(std::unique_ptr<StatementHandle> stmt, size_t batch_size,
+           bool any_column_getdata = false)
+        : stmt_(std::move(stmt))
+        , fetcher_(new BlockFetcher(stmt_->get(), batch_size, {}, any_column_getdata))
+        , batch_(fetcher_->schema()) {}
+    
+    ~Cursor() {
+        close();
+    }
+    
+    Cursor(Cursor&& other) noexcept
+        : stmt_(std::move(other.stmt_))
+        , fetcher_(std::move(other.fetcher_))
+        , batch_(std::move(other.batch_))
+        , position_(other.position_)
+        , rows_read_(other.rows_read_)
+        , started_(other.started_) {
+        other.reset_moved_from();
+    }
+
+    // 先关闭当前游标，fetcher_必须在其语句句柄释放前销毁
+    Cursor& operator=(Cursor&& other) noexcept {
+        if (this != &other) {
+            close();
+            stmt_ = std::move(other.stmt_);
+            fetcher_ = std::move(other.fetcher_);
+            batch_ = std::move(other.batch_);
+            position_ = other.position_;
+            rows_read_ = other.rows_read_;
+            started_ = other.started_;
+            other.reset_moved_from();
         }
+        return *this;
+    }
 
-        // 添加可选参数
-        if (!charset.empty()) {
-            oss << "CHARSET=" << charset << ";";
+    Cursor(const Cursor&) = delete;
+    Cursor& operator=(const Cursor&) = delete;
+    
+    const ResultSchema& schema() const { return batch_.schema(); }
+    
+    // 获取下一批，返回false表示已读完；batch()在下一次调用前有效
+    bool next_batch() {
+        batch_.clear();
+        position_ = 0;
+        if (!fetcher_) {
+            return false;
         }
-        if (timeout > 0) {
-            oss << "ConnectionTimeout=" << timeout << ";";
+        
+        while (batch_.empty()) {
+            size_t rows = fetcher_->fetch_block();
+            if (rows == 0) {
+                close();
+                return false;
+            }
+            fetcher_->append_block(batch_, rows);
         }
-        if (ssl) {
-            oss << "SSL Mode=REQUIRED;";
+        rows_read_ += batch_.size();
+        return true;
+    }
+    
+    const ResultSet& batch() const { return batch_; }
+    
+    // 逐行读取，返回false表示已读完
+    bool next() {
+        if (started_ && position_ + 1 < batch_.size()) {
+            ++position_;
+            return true;
         }
-        
-        // 数据库特定选项
-        if (databaseType == DatabaseType::MYSQL || databaseType == DatabaseType::MARIADB) {
-            oss << "OPTION=3;";  // 启用多语句和长缓冲区
-        } else if (databaseType == DatabaseType::POSTGRESQL) {
-            oss << "sslmode=require;";
+        started_ = true;
+        return next_batch();
+    }
+    
+    // 当前行，在下一次next()/next_batch()前有效
+    Row row() const { return batch_[position_]; }
+    
+    size_t rows_read() const { return rows_read_; }
+    bool is_open() const { return stmt_ != nullptr; }
+    
+    // 提前关闭游标并释放语句句柄
+    void close() {
+        fetcher_.reset();
+        if (stmt_) {
+            SQLCloseCursor(stmt_->get());
+            stmt_.reset();
         }
-        
-        return oss.str();
     }
+    
+private:
+    // 被移动后与已读完的游标相同：schema()与batch()为空，next()返回false
+    void reset_moved_from() {
+        batch_ = ResultSet(empty_schema());
+        position_ = 0;
+        rows_read_ = 0;
+        started_ = false;
+    }
+    
+    // 所有被移动后的游标共享，移动时不分配内存
+    static const ResultSchema::Ptr& empty_schema() {
+        static const ResultSchema::Ptr schema = std::make_shared<ResultSchema>();
+        return schema;
+    }
+    
+    std::unique_ptr<StatementHandle> stmt_;   // 必须先于fetcher_声明
+    std::unique_ptr<BlockFetcher> fetcher_;
+    ResultSet batch_;
+    size_t position_ = 0;
+    size_t rows_read_ = 0;
+    bool started_ = false;
 };
 
 // 主连接类
@@ -413,6 +2163,22 @@ public:
         connect(config);
     }
     
+    // 使用共享环境句柄建立连接
+    Connection(const ConnectionConfig& config, Environment::Ptr env)
+        : env_(std::move(env)) {
+        connect(config);
+    }
+    
+    // 只分配连接句柄而不连接数据库，is_connected()为true，执行语句会失败
+    // 用于在进程内测量连接池自身的借还开销
+    static Ptr offline(Environment::Ptr env = nullptr) {
+        Ptr conn(new Connection());
+        conn->env_ = env ? std::move(env) : Environment::create();
+        conn->conn_handle_ = std::make_unique<ConnectionHandle>(conn->env_->get());
+        conn->connected_ = true;
+        return conn;
+    }
+    
     ~Connection() {
         if (connected_) {
             try {
@@ -429,10 +2195,21 @@ public:
     
     // 允许移动
     Connection(Connection&& other) noexcept
-        : env_handle_(std::move(other.env_handle_))
+        : env_(std::move(other.env_))
         , conn_handle_(std::move(other.conn_handle_))
         , connected_(other.connected_)
-        , auto_commit_(other.auto_commit_) {
+        , auto_commit_(other.auto_commit_)
+        , default_auto_commit_(other.default_auto_commit_)
+        , in_transaction_(other.in_transaction_)
+        , transaction_dirty_(other.transaction_dirty_)
+        , fetch_block_size_(other.fetch_block_size_)
+        , param_batch_size_(other.param_batch_size_)
+        , any_column_getdata_(other.any_column_getdata_)
+        , last_used_(other.last_used_)
+        , last_validated_(other.last_validated_)
+        , idle_statements_(std::move(other.idle_statements_))
+        , metrics_(std::move(other.metrics_)) {
+        adopt_statement_cache(other);
         other.connected_ = false;
     }
     
@@ -441,10 +2218,21 @@ public:
             if (connected_) {
                 disconnect();
             }
-            env_handle_ = std::move(other.env_handle_);
+            env_ = std::move(other.env_);
             conn_handle_ = std::move(other.conn_handle_);
             connected_ = other.connected_;
             auto_commit_ = other.auto_commit_;
+            default_auto_commit_ = other.default_auto_commit_;
+            in_transaction_ = other.in_transaction_;
+            transaction_dirty_ = other.transaction_dirty_;
+            fetch_block_size_ = other.fetch_block_size_;
+            param_batch_size_ = other.param_batch_size_;
+            any_column_getdata_ = other.any_column_getdata_;
+            last_used_ = other.last_used_;
+            last_validated_ = other.last_validated_;
+            idle_statements_ = std::move(other.idle_statements_);
+            metrics_ = std::move(other.metrics_);
+            adopt_statement_cache(other);
             other.connected_ = false;
         }
         return *this;
@@ -453,24 +2241,20 @@ public:
     // 连接到数据库
     void connect(const ConnectionConfig& config) {
         try {
-            // 1. 创建环境句柄
-            env_handle_ = std::make_unique<EnvironmentHandle>();
-            
-            // 2. 设置ODBC版本
-            env_handle_->check(
-                SQLSetEnvAttr(env_handle_->get(), SQL_ATTR_ODBC_VERSION, 
-                            (void*)SQL_OV_ODBC3, 0),
-                "Set ODBC version"
-            );
+            // 1. 获取环境句柄（未共享时单独创建）
+            if (!env_) {
+                env_ = config.driver_pooling ? Environment::process_shared(true)
+                                             : Environment::create();
+            }
             
-            // 3. 创建连接句柄
-            conn_handle_ = std::make_unique<ConnectionHandle>(env_handle_->get());
+            // 2. 创建连接句柄
+            conn_handle_ = std::make_unique<ConnectionHandle>(env_->get());
             
-            // 4. 设置连接超时
+            // 3. 设置连接超时
             SQLSetConnectAttr(conn_handle_->get(), SQL_LOGIN_TIMEOUT, 
                             (SQLPOINTER)(long)config.timeout, 0);
             
-            // 5. 建立连接
+            // 4. 建立连接
             std::string conn_str = config.to_connection_string();
             SQLCHAR outstr[1024];
             SQLSMALLINT outstrlen;
@@ -490,9 +2274,20 @@ public:
                                    SQL_HANDLE_DBC, conn_handle_->get());
             }
             connected_ = true;
-            auto_commit_ = config.auto_commit;
-            // 6. 设置自动提交
-            set_auto_commit(config.auto_commit);
+            auto_commit_ = true;
+            in_transaction_ = false;
+            transaction_dirty_ = false;
+            fetch_block_size_ = config.fetch_block_size;
+            param_batch_size_ = config.param_batch_size;
+            SQLUINTEGER getdata_extensions = 0;
+            SQLGetInfo(conn_handle_->get(), SQL_GETDATA_EXTENSIONS, &getdata_extensions,
+                       sizeof(getdata_extensions), nullptr);
+            any_column_getdata_ = (getdata_extensions & SQL_GD_ANY_COLUMN) != 0;
+            // 5. 设置自动提交，ODBC默认即为自动提交，只在需要手动提交时设置
+            default_auto_commit_ = config.auto_commit;
+            if (!config.auto_commit) {
+                apply_auto_commit(false);
+            }
             
             
             // std::cout << "Connected to database successfully" << std::endl;
@@ -508,13 +2303,16 @@ public:
         if (!connected_) return;
         
         try {
+            // 语句句柄必须在断开前释放
+            clear_statement_cache();
+            idle_statements_.clear();
             if (conn_handle_) {
                 SQLDisconnect(conn_handle_->get());
             }
             connected_ = false;
             // std::cout << "Disconnected from database" << std::endl;
         } catch (const std::exception& e) {
-            std::cerr << "Error during disconnect: " << e.what() << std::endl;
+            ODBC_LOG_ERROR("Error during disconnect: " << e.what());
             throw;
         }
     }
@@ -525,12 +2323,10 @@ public:
             throw std::runtime_error("Not connected to database");
         }
         
-        StatementHandle stmt(conn_handle_->get());
+        StatementLease lease(this);
+        StatementHandle& stmt = lease.get();
         
-        stmt.check(
-            SQLExecDirect(stmt.get(), (SQLCHAR*)sql.c_str(), SQL_NTS),
-            "Execute SQL: " + sql
-        );
+        exec_direct(stmt, sql, "Execute SQL: ");
         
         // 获取影响的行数
         SQLLEN row_count = 0;
@@ -545,22 +2341,159 @@ public:
             throw std::runtime_error("Not connected to database");
         }
         
-        StatementHandle stmt(conn_handle_->get());
+        StatementLease lease(this);
+        StatementHandle& stmt = lease.get();
         
-        stmt.check(
-            SQLExecDirect(stmt.get(), (SQLCHAR*)sql.c_str(), SQL_NTS),
-            "Execute query: " + sql
-        );
+        exec_direct(stmt, sql, "Execute query: ");
         
         return fetch_results(stmt);
     }
     
+    // 一次往返执行多条语句，按顺序返回每条语句的结果集或影响行数
+    // MySQL/MariaDB需在ConnectionConfig中开启multi_statements
+    std::vector<StatementResult> query_multi(const std::string& script) {
+        if (!connected_) {
+            throw std::runtime_error("Not connected to database");
+        }
+        
+        StatementLease lease(this);
+        StatementHandle& stmt = lease.get();
+        
+        exec_direct(stmt, script, "Execute script: ");
+        
+        return fetch_all_results(stmt);
+    }
+    
+    std::vector<StatementResult> query_multi(const std::vector<std::string>& statements) {
+        std::string script;
+        for (const auto& sql : statements) {
+            if (!script.empty()) {
+                script += ";\n";
+            }
+            script += sql;
+        }
+        return query_multi(script);
+    }
+    
+    // 按编译期类型执行查询，T为std::tuple或已特化RowMapper的结构体
+    template<typename T>
+    std::vector<T> query_as(const std::string& sql) {
+        if (!connected_) {
+            throw std::runtime_error("Not connected to database");
+        }
+        
+        StatementLease lease(this);
+        StatementHandle& stmt = lease.get();
+        
+        exec_direct(stmt, sql, "Execute query: ");
+        
+        return fetch_typed<T>(stmt);
+    }
+    
+    // 异步执行的一条SQL语句
+    // 驱动支持时使用SQL_ATTR_ASYNC_ENABLE轮询模式，poll()在语句完成前立即返回false；
+    // 不支持时poll()同步执行。完成后可取结果，对象不能比所属连接存活更久
+    class AsyncStatement {
+    public:
+        AsyncStatement(Connection* conn, const std::string& sql)
+            : conn_(conn)
+            , stmt_(conn->conn_handle_->get())
+            , sql_(sql) {
+            async_ = SQL_SUCCEEDED(SQLSetStmtAttr(stmt_.get(), SQL_ATTR_ASYNC_ENABLE,
+                                                  (SQLPOINTER)SQL_ASYNC_ENABLE_ON, 0));
+        }
+        
+        ~AsyncStatement() {
+            if (!done_ && started_) {
+                SQLCancel(stmt_.get());
+            }
+        }
+        
+        AsyncStatement(const AsyncStatement&) = delete;
+        AsyncStatement& operator=(const AsyncStatement&) = delete;
+        
+        // 推进执行，完成时返回true，失败时抛出异常
+        bool poll() {
+            if (done_) {
+                return true;
+            }
+            if (!started_) {
+                conn_->begin_statement();
+                started_ = true;
+                start_ = std::chrono::steady_clock::now();
+            }
+            SQLRETURN ret = SQLExecDirect(stmt_.get(), (SQLCHAR*)sql_.c_str(), SQL_NTS);
+            if (ret == SQL_STILL_EXECUTING) {
+                return false;
+            }
+            done_ = true;
+            if (LatencyHistogram* histogram = conn_->execute_histogram()) {
+                histogram->record(std::chrono::steady_clock::now() - start_);
+            }
+            // 取数按同步方式进行
+            if (async_) {
+                SQLSetStmtAttr(stmt_.get(), SQL_ATTR_ASYNC_ENABLE,
+                               (SQLPOINTER)SQL_ASYNC_ENABLE_OFF, 0);
+            }
+            stmt_.check(ret, "Execute async: " + sql_);
+            return true;
+        }
+        
+        // 语句完成后获取结果集
+        ResultSet fetch_results() {
+            if (!done_) {
+                throw std::logic_error("Async statement has not completed");
+            }
+            return conn_->fetch_results(stmt_);
+        }
+        
+        size_t row_count() const {
+            SQLLEN row_count = 0;
+            SQLRowCount(stmt_.get(), &row_count);
+            return static_cast<size_t>(row_count);
+        }
+        
+        bool is_async() const { return async_; }
+        bool is_done() const { return done_; }
+        
+    private:
+        Connection* conn_;
+        StatementHandle stmt_;
+        std::string sql_;
+        bool async_ = false;
+        bool started_ = false;
+        bool done_ = false;
+        std::chrono::steady_clock::time_point start_;
+    };
+    
+    std::unique_ptr<AsyncStatement> begin_async(const std::string& sql) {
+        if (!connected_) {
+            throw std::runtime_error("Not connected to database");
+        }
+        return std::unique_ptr<AsyncStatement>(new AsyncStatement(this, sql));
+    }
+    
+    // 执行查询并返回只进游标，batch_size为0时使用fetch_block_size
+    Cursor open_cursor(const std::string& sql, size_t batch_size = 0) {
+        if (!connected_) {
+            throw std::runtime_error("Not connected to database");
+        }
+        
+        std::unique_ptr<StatementHandle> stmt(new StatementHandle(conn_handle_->get()));
+        
+        exec_direct(*stmt, sql, "Execute query: ");
+        
+        return Cursor(std::move(stmt), batch_size > 0 ? batch_size : fetch_block_size_,
+                      any_column_getdata_);
+    }
+    
     // 预备语句执行
     class PreparedStatement {
     public:
         PreparedStatement(Connection* conn, const std::string& sql)
             : conn_(conn)
             , stmt_(conn->conn_handle_->get())
+            , sql_(sql)
             , param_count_(0) {
             
             // 准备语句
@@ -569,27 +2502,42 @@ public:
                 "Prepare statement: " + sql
             );
             
-            // 获取参数个数
+            // 获取参数个数，参数槽创建后不再扩容，保证绑定地址稳定
             SQLNumParams(stmt_.get(), &param_count_);
-            param_values_.resize(param_count_);
-            param_lengths_.resize(param_count_, SQL_NTS);
+            params_.resize(param_count_);
         }
         
         // 绑定参数
+        // 值被复制到语句内部的参数区，调用后实参可以释放；
+        // 类型与缓冲区不变时再次绑定只更新值，不会重复调用SQLBindParameter
         template<typename T>
         void bind_param(SQLUSMALLINT index, const T& value) {
-            if (index < 1 || index > param_count_) {
-                throw std::out_of_range("Parameter index out of range");
+            bind_impl(slot(index), value);
+        }
+        
+        // 绑定NULL，sql_type用于尚未绑定过该参数时告知驱动参数类型
+        void bind_null(SQLUSMALLINT index, SQLSMALLINT sql_type = SQL_VARCHAR) {
+            ParamSlot& p = slot(index);
+            if (p.c_type == 0) {
+                set_shape(p, SQL_C_CHAR, sql_type, 1, 0, &p.inline_value, 1);
             }
-            bind_impl(index, value);
+            p.indicator = SQL_NULL_DATA;
+            p.assigned = true;
         }
         
         // 执行
         size_t execute() {
-            stmt_.check(
-                SQLExecute(stmt_.get()),
-                "Execute prepared statement"
-            );
+            bind_pending();
+            // 关闭上次执行留下的游标，fetch_results读完后不会关闭
+            SQLFreeStmt(stmt_.get(), SQL_CLOSE);
+            conn_->begin_statement();
+            {
+                ScopedLatency timer(conn_->execute_histogram());
+                stmt_.check(
+                    SQLExecute(stmt_.get()),
+                    "Execute prepared statement"
+                );
+            }
             
             SQLLEN row_count = 0;
             SQLRowCount(stmt_.get(), &row_count);
@@ -602,117 +2550,500 @@ public:
             return conn_->fetch_results(stmt_);
         }
         
-    private:
-        template<typename T>
-        void bind_impl(SQLUSMALLINT index, const T& value,
-                      typename std::enable_if<std::is_integral<T>::value>::type* = 0) {
-            param_values_[index - 1] = static_cast<SQLINTEGER>(value);
-            stmt_.check(
-                SQLBindParameter(stmt_.get(), index, SQL_PARAM_INPUT,
-                               SQL_C_SLONG, SQL_INTEGER, 0, 0,
-                               &param_values_[index - 1], 0, nullptr),
-                "Bind integer parameter"
-            );
+        // 执行并读取全部结果（如返回多个结果集的存储过程）
+        std::vector<StatementResult> execute_multi() {
+            execute();
+            return conn_->fetch_all_results(stmt_);
+        }
+        
+        // 执行查询并按编译期类型解码
+        template<typename T>
+        std::vector<T> execute_query_as() {
+            execute();
+            return conn_->fetch_typed<T>(stmt_);
+        }
+        
+        // 数组绑定批量执行，每块最多chunk_size行(0为使用连接配置)
+        // 执行后参数绑定被重置，之后逐个执行需重新bind_param
+        BatchResult execute_batch(const ParamBatch& batch, size_t chunk_size = 0) {
+            if (batch.column_count() != static_cast<size_t>(param_count_)) {
+                throw std::invalid_argument("Batch column count does not match statement parameters");
+            }
+            if (chunk_size == 0) {
+                chunk_size = conn_->param_batch_size_;
+            }
+            chunk_size = std::max<size_t>(1, chunk_size);
+            
+            BatchResult result;
+            result.row_status.assign(batch.rows(), SQL_PARAM_UNUSED);
+            
+            SQLFreeStmt(stmt_.get(), SQL_CLOSE);
+            SQLFreeStmt(stmt_.get(), SQL_RESET_PARAMS);
+            unbind_all();
+            stmt_.check(
+                SQLSetStmtAttr(stmt_.get(), SQL_ATTR_PARAM_BIND_TYPE,
+                               (SQLPOINTER)SQL_PARAM_BIND_BY_COLUMN, 0),
+                "Set parameter bind type");
+            
+            conn_->begin_statement();
+            try {
+                for (size_t offset = 0; offset < batch.rows(); offset += chunk_size) {
+                    size_t rows = std::min(chunk_size, batch.rows() - offset);
+                    execute_chunk(batch, offset, rows, result);
+                }
+            } catch (...) {
+                end_batch();
+                throw;
+            }
+            end_batch();
+            return result;
+        }
+        
+        const std::string& sql() const { return sql_; }
+        
+    private:
+        friend class Connection;
+        
+        void execute_chunk(const ParamBatch& batch, size_t offset, size_t rows,
+                           BatchResult& result) {
+            SQLULEN processed = 0;
+            SQLSetStmtAttr(stmt_.get(), SQL_ATTR_PARAMSET_SIZE, (SQLPOINTER)rows, 0);
+            SQLSetStmtAttr(stmt_.get(), SQL_ATTR_PARAM_STATUS_PTR,
+                           result.row_status.data() + offset, 0);
+            SQLSetStmtAttr(stmt_.get(), SQL_ATTR_PARAMS_PROCESSED_PTR, &processed, 0);
+            
+            // 每块重新绑定到本块起始位置
+            const auto& columns = batch.columns();
+            for (size_t i = 0; i < columns.size(); ++i) {
+                const auto& col = columns[i];
+                // 全为空串时宽度为1，许多驱动不接受长度为0的SQL_VARCHAR(HY104)
+                SQLULEN column_size = col.c_type == SQL_C_CHAR
+                    ? std::max<SQLULEN>(1, static_cast<SQLULEN>(col.width - 1)) : 0;
+                stmt_.check(
+                    SQLBindParameter(stmt_.get(), static_cast<SQLUSMALLINT>(i + 1),
+                                     SQL_PARAM_INPUT, col.c_type, col.sql_type,
+                                     column_size, 0,
+                                     (SQLPOINTER)(col.data.data() + offset * col.width),
+                                     col.width,
+                                     const_cast<SQLLEN*>(col.indicators.data() + offset)),
+                    "Bind batch parameter");
+            }
+            
+            SQLRETURN ret;
+            {
+                ScopedLatency timer(conn_->execute_histogram());
+                ret = SQLExecute(stmt_.get());
+            }
+            result.rows_processed += processed;
+            
+            // 仅在驱动未给出逐行状态时视为整体失败
+            if (!SQL_SUCCEEDED(ret)) {
+                auto begin = result.row_status.begin() + offset;
+                bool per_row = std::find(begin, begin + rows,
+                                         static_cast<SQLUSMALLINT>(SQL_PARAM_ERROR)) != begin + rows;
+                if (!per_row) {
+                    stmt_.check(ret, "Execute batch");
+                }
+            }
+            
+            SQLLEN row_count = 0;
+            if (SQL_SUCCEEDED(SQLRowCount(stmt_.get(), &row_count)) && row_count > 0) {
+                result.rows_affected += static_cast<size_t>(row_count);
+            }
+            SQLFreeStmt(stmt_.get(), SQL_CLOSE);
+        }
+        
+        // 恢复单行参数执行状态
+        void end_batch() {
+            SQLSetStmtAttr(stmt_.get(), SQL_ATTR_PARAMSET_SIZE, (SQLPOINTER)1, 0);
+            SQLSetStmtAttr(stmt_.get(), SQL_ATTR_PARAM_STATUS_PTR, nullptr, 0);
+            SQLSetStmtAttr(stmt_.get(), SQL_ATTR_PARAMS_PROCESSED_PTR, nullptr, 0);
+            SQLFreeStmt(stmt_.get(), SQL_RESET_PARAMS);
+            unbind_all();
+        }
+        
+        // 归还缓存前关闭游标，保留已准备的执行计划与参数绑定；
+        // 参数值标记为未设置，下一个使用者必须重新bind_param
+        void reset() {
+            SQLFreeStmt(stmt_.get(), SQL_CLOSE);
+            for (auto& p : params_) {
+                p.assigned = false;
+            }
+        }
+        
+        // 参数槽：定长值内联存放，变长值存放在arena_中预留的区域
+        struct ParamSlot {
+            SQLSMALLINT c_type = 0;          // 0表示从未绑定
+            SQLSMALLINT sql_type = 0;
+            SQLULEN column_size = 0;
+            SQLSMALLINT decimal_digits = 0;
+            SQLPOINTER buffer = nullptr;     // 当前绑定的缓冲区
+            SQLLEN buffer_length = 0;
+            SQLLEN indicator = 0;
+            size_t offset = 0;               // 变长数据在arena_中的偏移
+            size_t capacity = 0;             // 变长数据已预留的字节数
+            bool dirty = true;               // 需要重新调用SQLBindParameter
+            bool assigned = false;           // 本次借出后是否已设置值
+            union {
+                SQLINTEGER i32;
+                SQLBIGINT i64;
+                double f64;
+                unsigned char bit;
+                TIMESTAMP_STRUCT ts;
+            } inline_value;
+        };
+        
+        ParamSlot& slot(SQLUSMALLINT index) {
+            if (index < 1 || index > param_count_) {
+                throw std::out_of_range("Parameter index out of range");
+            }
+            return params_[index - 1];
+        }
+        
+        // 记录绑定形态，与已绑定的不同时标记为需要重新绑定
+        static void set_shape(ParamSlot& p, SQLSMALLINT c_type, SQLSMALLINT sql_type,
+                              SQLULEN column_size, SQLSMALLINT decimal_digits,
+                              SQLPOINTER buffer, SQLLEN buffer_length) {
+            if (p.c_type != c_type || p.sql_type != sql_type || p.column_size != column_size
+                || p.decimal_digits != decimal_digits || p.buffer != buffer
+                || p.buffer_length != buffer_length) {
+                p.c_type = c_type;
+                p.sql_type = sql_type;
+                p.column_size = column_size;
+                p.decimal_digits = decimal_digits;
+                p.buffer = buffer;
+                p.buffer_length = buffer_length;
+                p.dirty = true;
+            }
+        }
+        
+        template<typename T>
+        void set_fixed(ParamSlot& p, SQLSMALLINT c_type, SQLSMALLINT sql_type,
+                       SQLULEN column_size, SQLSMALLINT decimal_digits, const T& value) {
+            std::memcpy(&p.inline_value, &value, sizeof(T));
+            set_shape(p, c_type, sql_type, column_size, decimal_digits, &p.inline_value, 0);
+            p.indicator = 0;
+            p.assigned = true;
+        }
+        
+        // 复制变长数据；容量不足时在arena_末尾重新预留，arena_扩容后所有变长参数需重新绑定
+        void set_variable(ParamSlot& p, SQLSMALLINT c_type, SQLSMALLINT sql_type,
+                          const void* data, size_t len) {
+            if (p.capacity == 0 || len > p.capacity) {
+                size_t capacity = std::max<size_t>(32, p.capacity);
+                while (capacity < len) {
+                    capacity *= 2;
+                }
+                const char* old_base = arena_.data();
+                p.offset = arena_.size();
+                p.capacity = capacity;
+                arena_.resize(arena_.size() + capacity);
+                if (arena_.data() != old_base) {
+                    rebase_variable_slots();
+                }
+            }
+            if (len > 0) {
+                std::memcpy(arena_.data() + p.offset, data, len);
+            }
+            set_shape(p, c_type, sql_type, p.capacity, 0, arena_.data() + p.offset,
+                      static_cast<SQLLEN>(p.capacity));
+            p.indicator = static_cast<SQLLEN>(len);
+            p.assigned = true;
+        }
+        
+        void rebase_variable_slots() {
+            for (auto& p : params_) {
+                if (p.capacity > 0) {
+                    p.buffer = arena_.data() + p.offset;
+                    p.dirty = true;
+                }
+            }
+        }
+        
+        // SQL_RESET_PARAMS之后所有参数需重新绑定
+        void unbind_all() {
+            for (auto& p : params_) {
+                p.dirty = true;
+                p.assigned = false;
+            }
+        }
+        
+        // 执行前只为形态变化的参数调用SQLBindParameter
+        void bind_pending() {
+            for (size_t i = 0; i < params_.size(); ++i) {
+                ParamSlot& p = params_[i];
+                if (!p.assigned) {
+                    throw std::runtime_error("Parameter " + std::to_string(i + 1) + " is not bound");
+                }
+                if (!p.dirty) {
+                    continue;
+                }
+                stmt_.check(
+                    SQLBindParameter(stmt_.get(), static_cast<SQLUSMALLINT>(i + 1),
+                                     SQL_PARAM_INPUT, p.c_type, p.sql_type,
+                                     p.column_size, p.decimal_digits,
+                                     p.buffer, p.buffer_length, &p.indicator),
+                    "Bind parameter " + std::to_string(i + 1));
+                p.dirty = false;
+            }
+        }
+        
+        // 能放入SQLINTEGER的整数
+        template<typename T>
+        void bind_impl(ParamSlot& p, const T& value,
+                      typename std::enable_if<std::is_integral<T>::value
+                                              && (sizeof(T) < sizeof(SQLINTEGER)
+                                                  || (sizeof(T) == sizeof(SQLINTEGER)
+                                                      && std::is_signed<T>::value))>::type* = 0) {
+            set_fixed(p, SQL_C_SLONG, SQL_INTEGER, 0, 0, static_cast<SQLINTEGER>(value));
+        }
+        
+        // 64位有符号整数，以及超过INT_MAX会变为负数的32位无符号整数
+        template<typename T>
+        void bind_impl(ParamSlot& p, const T& value,
+                      typename std::enable_if<std::is_integral<T>::value
+                                              && ((sizeof(T) == sizeof(SQLINTEGER)
+                                                   && std::is_unsigned<T>::value)
+                                                  || (sizeof(T) > sizeof(SQLINTEGER)
+                                                      && std::is_signed<T>::value))>::type* = 0) {
+            set_fixed(p, SQL_C_SBIGINT, SQL_BIGINT, 0, 0, static_cast<SQLBIGINT>(value));
+        }
+        
+        template<typename T>
+        void bind_impl(ParamSlot& p, const T& value,
+                      typename std::enable_if<std::is_integral<T>::value
+                                              && (sizeof(T) > sizeof(SQLINTEGER))
+                                              && std::is_unsigned<T>::value>::type* = 0) {
+            set_fixed(p, SQL_C_UBIGINT, SQL_BIGINT, 0, 0, static_cast<SQLUBIGINT>(value));
+        }
+        
+        template<typename T>
+        void bind_impl(ParamSlot& p, const T& value,
+                      typename std::enable_if<std::is_floating_point<T>::value>::type* = 0) {
+            set_fixed(p, SQL_C_DOUBLE, SQL_DOUBLE, 0, 0, static_cast<double>(value));
+        }
+        
+        void bind_impl(ParamSlot& p, bool value) {
+            set_fixed(p, SQL_C_BIT, SQL_BIT, 1, 0, static_cast<unsigned char>(value ? 1 : 0));
+        }
+        
+        void bind_impl(ParamSlot& p, const std::string& value) {
+            set_variable(p, SQL_C_CHAR, SQL_VARCHAR, value.data(), value.size());
+        }
+        
+        void bind_impl(ParamSlot& p, const char* value) {
+            set_variable(p, SQL_C_CHAR, SQL_VARCHAR, value, std::strlen(value));
+        }
+        
+        // 二进制/BLOB
+        void bind_impl(ParamSlot& p, const std::vector<unsigned char>& value) {
+            set_variable(p, SQL_C_BINARY, SQL_VARBINARY, value.data(), value.size());
         }
         
-        void bind_impl(SQLUSMALLINT index, const std::string& value) {
-            param_values_[index - 1] = value;
-            param_lengths_[index - 1] = value.length();
-            stmt_.check(
-                SQLBindParameter(stmt_.get(), index, SQL_PARAM_INPUT,
-                               SQL_C_CHAR, SQL_VARCHAR, value.length(), 0,
-                               (SQLPOINTER)value.c_str(), value.length(), 
-                               &param_lengths_[index - 1]),
-                "Bind string parameter"
-            );
+        // 时间戳，精确到微秒
+        void bind_impl(ParamSlot& p, const TIMESTAMP_STRUCT& value) {
+            set_fixed(p, SQL_C_TYPE_TIMESTAMP, SQL_TYPE_TIMESTAMP, 26, 6, value);
         }
         
-        void bind_impl(SQLUSMALLINT index, double value) {
-            param_values_[index - 1] = value;
-            stmt_.check(
-                SQLBindParameter(stmt_.get(), index, SQL_PARAM_INPUT,
-                               SQL_C_DOUBLE, SQL_DOUBLE, 0, 0,
-                               &param_values_[index - 1], 0, nullptr),
-                "Bind double parameter"
-            );
+        void bind_impl(ParamSlot& p, const std::chrono::system_clock::time_point& value) {
+            bind_impl(p, to_timestamp_struct(value));
+        }
+        
+        void bind_impl(ParamSlot& p, std::nullptr_t) {
+            bind_null(static_cast<SQLUSMALLINT>(&p - params_.data() + 1));
         }
         
         Connection* conn_;
         StatementHandle stmt_;
+        std::string sql_;
         SQLSMALLINT param_count_;
-        std::vector<boost::any> param_values_;
-        std::vector<SQLLEN> param_lengths_;
+        std::vector<ParamSlot> params_;
+        std::vector<char> arena_;           // 所有变长参数共用的连续缓冲区
+    };
+    
+    // 预备语句释放器，启用缓存时将语句归还给所属连接
+    struct StatementReleaser {
+        Connection* conn = nullptr;
+        void operator()(PreparedStatement* stmt) const {
+            if (conn) {
+                conn->release_statement(std::unique_ptr<PreparedStatement>(stmt));
+            } else {
+                delete stmt;
+            }
+        }
+    };
+    using PreparedStatementPtr = std::unique_ptr<PreparedStatement, StatementReleaser>;
+    
+    struct StatementCacheStats {
+        size_t hits = 0;
+        size_t misses = 0;
+        size_t size = 0;        ///< 缓存中的语句数（含已借出）
+        size_t capacity = 0;
     };
     
-    std::unique_ptr<PreparedStatement> prepare(const std::string& sql) {
-        return std::make_unique<PreparedStatement>(this, sql);
+    // 准备语句，启用缓存时按SQL文本复用已准备的语句
+    // 返回的语句必须在连接断开或销毁前释放
+    PreparedStatementPtr prepare(const std::string& sql) {
+        if (statement_cache_capacity_ == 0) {
+            return PreparedStatementPtr(new PreparedStatement(this, sql), StatementReleaser{});
+        }
+        
+        auto it = statement_index_.find(sql);
+        if (it != statement_index_.end() && it->second->stmt) {
+            // 命中：从缓存节点借出，节点移到最近使用端
+            ++statement_cache_hits_;
+            statement_lru_.splice(statement_lru_.begin(), statement_lru_, it->second);
+            return PreparedStatementPtr(it->second->stmt.release(), StatementReleaser{this});
+        }
+        
+        ++statement_cache_misses_;
+        PreparedStatementPtr stmt(new PreparedStatement(this, sql), StatementReleaser{this});
+        if (it == statement_index_.end()) {
+            statement_lru_.push_front(CachedStatement{sql, nullptr});
+            statement_index_.emplace(sql, statement_lru_.begin());
+            evict_statements();
+        }
+        return stmt;
+    }
+    
+    void set_statement_cache_capacity(size_t capacity) {
+        statement_cache_capacity_ = capacity;
+        evict_statements();
+    }
+    
+    StatementCacheStats statement_cache_stats() const {
+        StatementCacheStats stats;
+        stats.hits = statement_cache_hits_;
+        stats.misses = statement_cache_misses_;
+        stats.size = statement_lru_.size();
+        stats.capacity = statement_cache_capacity_;
+        return stats;
+    }
+    
+    // 释放所有缓存的语句
+    void clear_statement_cache() {
+        statement_index_.clear();
+        statement_lru_.clear();
     }
     
     // 开始事务
+    // 自动提交模式只在确实需要时切换：提交或回滚后保持手动提交，
+    // 直到下一条事务外的语句执行前才恢复，连续事务之间不再来回切换
     void begin_transaction() {
         if (!connected_) {
             throw std::runtime_error("Not connected to database");
         }
         
         if (auto_commit_) {
-            set_auto_commit(false);
+            apply_auto_commit(false);
         }
+        in_transaction_ = true;
     }
     
-    // 提交事务
+    // 提交事务，事务内未执行语句时不访问服务器
     void commit() {
+        end_transaction(SQL_COMMIT, "Failed to commit transaction");
+    }
+    
+    // 回滚事务
+    void rollback() {
+        end_transaction(SQL_ROLLBACK, "Failed to rollback transaction");
+    }
+    
+    // 设置自动提交，同时作为事务外语句的默认模式
+    void set_auto_commit(bool enable) {
         if (!connected_) {
             throw std::runtime_error("Not connected to database");
         }
         
-        SQLRETURN ret = SQLEndTran(SQL_HANDLE_DBC, conn_handle_->get(), SQL_COMMIT);
-        if (!SQL_SUCCEEDED(ret)) {
-            throw OdbcException("Failed to commit transaction", 
-                               SQL_HANDLE_DBC, conn_handle_->get());
-        }
-        
-        if (!auto_commit_) {
-            set_auto_commit(true);
+        default_auto_commit_ = enable;
+        if (auto_commit_ != enable) {
+            apply_auto_commit(enable);
         }
     }
     
-    // 回滚事务
-    void rollback() {
+    // 回滚未结束的事务，供连接池在归还时重置会话状态，没有未提交的工作时不访问服务器
+    void reset_session() {
         if (!connected_) {
-            throw std::runtime_error("Not connected to database");
+            return;
+        }
+        if (in_transaction_ || transaction_dirty_) {
+            end_transaction(SQL_ROLLBACK, "Failed to rollback transaction");
+        }
+    }
+    
+    // 显式事务作用域，析构时未提交则回滚
+    class Transaction {
+    public:
+        explicit Transaction(Connection* conn) : conn_(conn) {
+            conn_->begin_transaction();
         }
         
-        SQLRETURN ret = SQLEndTran(SQL_HANDLE_DBC, conn_handle_->get(), SQL_ROLLBACK);
-        if (!SQL_SUCCEEDED(ret)) {
-            throw OdbcException("Failed to rollback transaction", 
-                               SQL_HANDLE_DBC, conn_handle_->get());
+        ~Transaction() {
+            if (conn_) {
+                try {
+                    conn_->rollback();
+                } catch (const std::exception& e) {
+                    ODBC_LOG_ERROR("Transaction rollback failed: " << e.what());
+                }
+            }
         }
         
-        if (!auto_commit_) {
-            set_auto_commit(true);
+        Transaction(const Transaction&) = delete;
+        Transaction& operator=(const Transaction&) = delete;
+        
+        Transaction(Transaction&& other) noexcept : conn_(other.conn_) {
+            other.conn_ = nullptr;
         }
-    }
-    
-    // 设置自动提交
-    void set_auto_commit(bool enable) {
-        if (!connected_) {
-            throw std::runtime_error("Not connected to database");
+        
+        void commit() {
+            if (!conn_) {
+                throw std::logic_error("Transaction already finished");
+            }
+            Connection* conn = conn_;
+            conn_ = nullptr;
+            conn->commit();
         }
         
-        SQLUINTEGER mode = enable ? SQL_AUTOCOMMIT_ON : SQL_AUTOCOMMIT_OFF;
-        SQLRETURN ret = SQLSetConnectAttr(conn_handle_->get(), 
-                                         SQL_ATTR_AUTOCOMMIT, 
-                                         (SQLPOINTER)mode, 
-                                         0);
-        if (!SQL_SUCCEEDED(ret)) {
-            throw OdbcException("Failed to set autocommit mode", 
-                               SQL_HANDLE_DBC, conn_handle_->get());
+        void rollback() {
+            if (!conn_) {
+                throw std::logic_error("Transaction already finished");
+            }
+            Connection* conn = conn_;
+            conn_ = nullptr;
+            conn->rollback();
         }
-        auto_commit_ = enable;
+        
+        bool active() const { return conn_ != nullptr; }
+        
+    private:
+        Connection* conn_;
+    };
+    
+    Transaction transaction() {
+        return Transaction(this);
     }
     
     bool is_connected() const { return connected_; }
     bool is_auto_commit() const { return auto_commit_; }
+    bool in_transaction() const { return in_transaction_; }
+    
+    // 语句执行与取数耗时记录到metrics，为空时不计时
+    void set_metrics(std::shared_ptr<StatementMetrics> metrics) { metrics_ = std::move(metrics); }
+    
+    // 记录最近一次使用时间（由连接池在归还时调用）
+    void update_last_used() { last_used_ = std::chrono::steady_clock::now(); }
+    std::chrono::steady_clock::time_point last_used() const { return last_used_; }
+    
+    // 最近一次通过验证的时间（由连接池的健康检查记录）
+    void update_last_validated() { last_validated_ = std::chrono::steady_clock::now(); }
+    std::chrono::steady_clock::time_point last_validated() const { return last_validated_; }
+    
+    // 是否已空闲超过指定秒数
+    bool is_idle_timeout(size_t max_idle_seconds) const {
+        return std::chrono::steady_clock::now() - last_used_
+               >= std::chrono::seconds(max_idle_seconds);
+    }
     
     // 获取数据库元数据
     std::vector<std::string> get_tables() {
@@ -720,10 +3051,12 @@ public:
             throw std::runtime_error("Not connected to database");
         }
         
-        StatementHandle stmt(conn_handle_->get());
+        StatementLease lease(this);
+        StatementHandle& stmt = lease.get();
         std::vector<std::string> tables;
         
         // 获取表信息
+        begin_statement();
         stmt.check(
             SQLTables(stmt.get(), nullptr, 0, nullptr, 0, 
                      nullptr, 0, (SQLCHAR*)"TABLE", SQL_NTS),
@@ -744,280 +3077,270 @@ public:
         return tables;
     }
     
-    // 测试连接
-    bool ping() {
+    // 测试连接，timeout_seconds大于0时设置查询超时
+    // 与普通语句一样先恢复默认的提交模式；手动提交模式下由ping开启的事务随即回滚，空闲连接不会停留在事务中
+    bool ping(unsigned int timeout_seconds = 0) {
         if (!connected_) return false;
         
         try {
-            execute("SELECT 1");
-            return true;
+            bool was_clean = !in_transaction_ && !transaction_dirty_;
+            SQLRETURN ret;
+            {
+                StatementLease lease(this);
+                StatementHandle& stmt = lease.get();
+                if (timeout_seconds > 0) {
+                    SQLSetStmtAttr(stmt.get(), SQL_ATTR_QUERY_TIMEOUT,
+                                   (SQLPOINTER)(SQLULEN)timeout_seconds, 0);
+                }
+                begin_statement();
+                ret = SQLExecDirect(stmt.get(), (SQLCHAR*)"SELECT 1", SQL_NTS);
+                if (timeout_seconds > 0) {
+                    // 句柄会被复用，恢复为不超时
+                    SQLSetStmtAttr(stmt.get(), SQL_ATTR_QUERY_TIMEOUT, (SQLPOINTER)0, 0);
+                }
+            }
+            if (was_clean && transaction_dirty_) {
+                end_transaction(SQL_ROLLBACK, "Failed to rollback transaction");
+            }
+            return SQL_SUCCEEDED(ret);
         } catch (...) {
             return false;
         }
     }
     
-private:
-    // 获取结果集
-    ResultSet fetch_results(StatementHandle& stmt) {
-        ResultSet result_set;
+    // 检查连接是否仍可用
+    // 先读取驱动记录的连接状态(SQL_ATTR_CONNECTION_DEAD，无网络往返)，未判定为断开时再ping确认
+    bool validate(unsigned int timeout_seconds = 0) {
+        if (!connected_) return false;
         
-        // 获取列数
-        SQLSMALLINT column_count = 0;
-        SQLNumResultCols(stmt.get(), &column_count);
+        SQLUINTEGER dead = SQL_CD_FALSE;
+        SQLRETURN ret = SQLGetConnectAttr(conn_handle_->get(), SQL_ATTR_CONNECTION_DEAD,
+                                          &dead, 0, nullptr);
+        if (SQL_SUCCEEDED(ret) && dead == SQL_CD_TRUE) {
+            return false;
+        }
+        return ping(timeout_seconds);
+    }
+    
+private:
+    // 直接执行使用的语句句柄租约，析构时关闭游标并归还到连接的空闲句柄列表
+    class StatementLease {
+    public:
+        explicit StatementLease(Connection* conn) : conn_(conn) {
+            if (!conn_->idle_statements_.empty()) {
+                stmt_ = std::move(conn_->idle_statements_.back());
+                conn_->idle_statements_.pop_back();
+            } else {
+                stmt_.reset(new StatementHandle(conn_->conn_handle_->get()));
+            }
+        }
         
-        if (column_count == 0) {
-            return result_set;  // 无结果集
+        ~StatementLease() {
+            // 关闭失败的句柄不再复用
+            if (conn_->connected_
+                && conn_->idle_statements_.size() < kMaxIdleStatements
+                && SQL_SUCCEEDED(SQLFreeStmt(stmt_->get(), SQL_CLOSE))) {
+                conn_->idle_statements_.push_back(std::move(stmt_));
+            }
         }
         
-        // 获取列信息
-        std::vector<std::string> column_names;
-        std::vector<SQLSMALLINT> column_types;
+        StatementLease(const StatementLease&) = delete;
+        StatementLease& operator=(const StatementLease&) = delete;
         
-        for (SQLSMALLINT i = 1; i <= column_count; ++i) {
-            SQLCHAR column_name[256];
-            SQLSMALLINT name_len = 0;
-            SQLSMALLINT data_type = 0;
-            SQLULEN column_size = 0;
-            SQLSMALLINT decimal_digits = 0;
-            SQLSMALLINT nullable = 0;
-            
-            SQLDescribeCol(stmt.get(), i, column_name, sizeof(column_name),
-                          &name_len, &data_type, &column_size, 
-                          &decimal_digits, &nullable);
-            
-            column_names.push_back(reinterpret_cast<char*>(column_name));
-            column_types.push_back(data_type);
-        }
+        StatementHandle& get() { return *stmt_; }
         
-        // 获取数据
-        while (SQLFetch(stmt.get()) == SQL_SUCCESS) {
-            Row row;
-            
-            for (SQLSMALLINT i = 1; i <= column_count; ++i) {
-                // 检查是否为空
-                SQLLEN indicator = 0;
-                SQLGetData(stmt.get(), i, SQL_C_DEFAULT, nullptr, 0, &indicator);
-                
-                if (indicator == SQL_NULL_DATA) {
-                    row.add_column(column_names[i-1], Value());
-                    continue;
-                }
-                
-                // 根据列类型获取数据
-                switch (column_types[i-1]) {
-                    case SQL_INTEGER:
-                    case SQL_SMALLINT:
-                    case SQL_TINYINT: {
-                        SQLINTEGER int_val = 0;
-                        SQLGetData(stmt.get(), i, SQL_C_SLONG, &int_val, 0, nullptr);
-                        row.add_column(column_names[i-1], Value(int_val));
-                        break;
-                    }
-                    case SQL_BIGINT: {
-                        SQLBIGINT long_val = 0;
-                        SQLGetData(stmt.get(), i, SQL_C_SBIGINT, &long_val, 0, nullptr);
-                        row.add_column(column_names[i-1], Value(long_val));
-                        break;
-                    }
-                    case SQL_DOUBLE:
-                    case SQL_FLOAT:
-                    case SQL_REAL: {
-                        double double_val = 0.0;
-                        SQLGetData(stmt.get(), i, SQL_C_DOUBLE, &double_val, 0, nullptr);
-                        row.add_column(column_names[i-1], Value(double_val));
-                        break;
-                    }
-                    case SQL_DECIMAL:
-                    case SQL_NUMERIC: {
-                        SQL_NUMERIC_STRUCT numeric_val;
-                        SQLGetData(stmt.get(), i, SQL_C_NUMERIC, &numeric_val, 0, nullptr);
-                        // 转换为double
-                        double double_val = 0.0;
-                        SQL_NUMERIC_STRUCT* num = &numeric_val;
-                        double_val = 0.0;
-                        for (int i = 0; i < SQL_MAX_NUMERIC_LEN; i++) {
-                            double_val = double_val * 256 + num->val[i];
-                        }
-                        for (int i = 0; i < num->scale; i++) {
-                            double_val /= 10.0;
-                        }
-                        if (num->sign == 0) {  // 负数
-                            double_val = -double_val;
-                        }
-                        row.add_column(column_names[i-1], Value(double_val));
-                        break;
-                    }
-                    case SQL_CHAR:
-                    case SQL_VARCHAR:
-                    case SQL_LONGVARCHAR: {
-                        // 先获取长度
-                        SQLLEN data_len = 0;
-                        SQLGetData(stmt.get(), i, SQL_C_CHAR, nullptr, 0, &data_len);
-                        
-                        if (data_len > 0) {
-                            std::vector<char> buffer(data_len + 1);
-                            SQLGetData(stmt.get(), i, SQL_C_CHAR, buffer.data(), 
-                                      buffer.size(), nullptr);
-                            row.add_column(column_names[i-1], 
-                                         Value(std::string(buffer.data())));
-                        } else {
-                            row.add_column(column_names[i-1], Value(""));
-                        }
-                        break;
-                    }
-                    case SQL_DATE:
-                    case SQL_TYPE_DATE: {
-                        DATE_STRUCT date_val;
-                        SQLGetData(stmt.get(), i, SQL_C_DATE, &date_val, 0, nullptr);
-                        // 转换为字符串
-                        std::ostringstream oss;
-                        oss << std::setfill('0')
-                            << std::setw(4) << date_val.year << "-"
-                            << std::setw(2) << date_val.month << "-"
-                            << std::setw(2) << date_val.day;
-                        row.add_column(column_names[i-1], Value(oss.str()));
-                        break;
-                    }
-                    case SQL_TIMESTAMP:
-                    case SQL_TYPE_TIMESTAMP: {
-                        TIMESTAMP_STRUCT ts_val;
-                        SQLGetData(stmt.get(), i, SQL_C_TIMESTAMP, &ts_val, 0, nullptr);
-                        // 转换为字符串
-                        std::ostringstream oss;
-                        oss << std::setfill('0')
-                            << std::setw(4) << ts_val.year << "-"
-                            << std::setw(2) << ts_val.month << "-"
-                            << std::setw(2) << ts_val.day << " "
-                            << std::setw(2) << ts_val.hour << ":"
-                            << std::setw(2) << ts_val.minute << ":"
-                            << std::setw(2) << ts_val.second;
-                        if (ts_val.fraction > 0) {
-                            oss << "." << std::setw(9) << ts_val.fraction;
-                        }
-                        row.add_column(column_names[i-1], Value(oss.str()));
-                        break;
-                    }
-                    case SQL_BIT: {
-                        unsigned char bool_val = 0;
-                        SQLGetData(stmt.get(), i, SQL_C_BIT, &bool_val, 0, nullptr);
-                        row.add_column(column_names[i-1], Value(bool_val != 0));
-                        break;
-                    }
-                    default: {
-                        // 默认按字符串处理
-                        char buffer[4096];
-                        SQLLEN len = 0;
-                        SQLGetData(stmt.get(), i, SQL_C_CHAR, buffer, 
-                                  sizeof(buffer), &len);
-                        if (len > 0) {
-                            row.add_column(column_names[i-1], 
-                                         Value(std::string(buffer, len)));
-                        } else {
-                            row.add_column(column_names[i-1], Value(""));
-                        }
-                        break;
-                    }
-                }
+    private:
+        Connection* conn_;
+        std::unique_ptr<StatementHandle> stmt_;
+    };
+    
+    static constexpr size_t kMaxIdleStatements = 4;  ///< 每个连接保留的空闲直接执行句柄数
+    
+    struct CachedStatement {
+        std::string sql;
+        std::unique_ptr<PreparedStatement> stmt;  // 借出期间为空
+    };
+    
+    void release_statement(std::unique_ptr<PreparedStatement> stmt) {
+        auto it = statement_index_.find(stmt->sql());
+        if (!connected_ || it == statement_index_.end() || it->second->stmt) {
+            // 已被淘汰或同一SQL同时借出了多份，直接释放
+            return;
+        }
+        stmt->reset();
+        it->second->stmt = std::move(stmt);
+    }
+    
+    // 从最久未用端淘汰超出容量的语句，已借出的语句归还时再释放
+    void evict_statements() {
+        auto it = statement_lru_.end();
+        while (statement_lru_.size() > statement_cache_capacity_
+               && it != statement_lru_.begin()) {
+            --it;
+            statement_index_.erase(it->sql);
+            it = statement_lru_.erase(it);
+        }
+    }
+    
+    // 连接对象移动后修正缓存语句的所属连接
+    void adopt_statement_cache(Connection& other) {
+        statement_lru_ = std::move(other.statement_lru_);
+        statement_index_ = std::move(other.statement_index_);
+        statement_cache_capacity_ = other.statement_cache_capacity_;
+        statement_cache_hits_ = other.statement_cache_hits_;
+        statement_cache_misses_ = other.statement_cache_misses_;
+        for (auto& entry : statement_lru_) {
+            if (entry.stmt) {
+                entry.stmt->conn_ = this;
             }
-            
-            result_set.add_row(std::move(row));
+        }
+    }
+    
+    // 执行语句前调用：事务外按默认模式恢复自动提交，手动提交模式下记录有未结束的工作
+    void begin_statement() {
+        if (!in_transaction_ && auto_commit_ != default_auto_commit_) {
+            apply_auto_commit(default_auto_commit_);
+        }
+        if (!auto_commit_) {
+            transaction_dirty_ = true;
+        }
+    }
+    
+    void apply_auto_commit(bool enable) {
+        SQLUINTEGER mode = enable ? SQL_AUTOCOMMIT_ON : SQL_AUTOCOMMIT_OFF;
+        SQLRETURN ret = SQLSetConnectAttr(conn_handle_->get(), 
+                                         SQL_ATTR_AUTOCOMMIT, 
+                                         (SQLPOINTER)(SQLULEN)mode, 
+                                         0);
+        if (!SQL_SUCCEEDED(ret)) {
+            throw OdbcException("Failed to set autocommit mode", 
+                               SQL_HANDLE_DBC, conn_handle_->get());
+        }
+        auto_commit_ = enable;
+    }
+    
+    void end_transaction(SQLSMALLINT completion, const char* error) {
+        if (!connected_) {
+            throw std::runtime_error("Not connected to database");
         }
         
-        return result_set;
+        bool pending = transaction_dirty_;
+        in_transaction_ = false;
+        transaction_dirty_ = false;
+        if (!pending) {
+            return;
+        }
+        SQLRETURN ret = SQLEndTran(SQL_HANDLE_DBC, conn_handle_->get(), completion);
+        if (!SQL_SUCCEEDED(ret)) {
+            throw OdbcException(error, SQL_HANDLE_DBC, conn_handle_->get());
+        }
     }
     
-private:
-    std::unique_ptr<EnvironmentHandle> env_handle_;
-    std::unique_ptr<ConnectionHandle> conn_handle_;
-    bool connected_ = false;
-    bool auto_commit_ = true;
-};
-
-// Value类型的转换实现
-template<>
-inline int Value::as<int>() const {
-    switch (type_) {
-        case Type::Integer: return static_cast<int>(int_val_);
-        case Type::Long: return static_cast<int>(long_val_);
-        case Type::Double: return static_cast<int>(double_val_);
-        case Type::Boolean: return bool_val_ ? 1 : 0;
-        case Type::String: return std::stoi(str_val_);
-        case Type::Null: throw std::runtime_error("Cannot convert NULL to int");
-        default: throw std::runtime_error("Invalid type conversion to int");
+    // 记录执行耗时的SQLExecDirect
+    void exec_direct(StatementHandle& stmt, const std::string& sql, const char* operation) {
+        begin_statement();
+        ScopedLatency timer(execute_histogram());
+        stmt.check(
+            SQLExecDirect(stmt.get(), (SQLCHAR*)sql.c_str(), SQL_NTS),
+            operation + sql
+        );
     }
-}
-
-template<>
-inline long long Value::as<long long>() const {
-    switch (type_) {
-        case Type::Integer: return static_cast<long long>(int_val_);
-        case Type::Long: return long_val_;
-        case Type::Double: return static_cast<long long>(double_val_);
-        case Type::Boolean: return bool_val_ ? 1 : 0;
-        case Type::String: return std::stoll(str_val_);
-        case Type::Null: throw std::runtime_error("Cannot convert NULL to long long");
-        default: throw std::runtime_error("Invalid type conversion to long long");
+    
+    LatencyHistogram* execute_histogram() const {
+        return metrics_ ? &metrics_->execute_time : nullptr;
     }
-}
-
-template<>
-inline double Value::as<double>() const {
-    switch (type_) {
-        case Type::Integer: return static_cast<double>(int_val_);
-        case Type::Long: return static_cast<double>(long_val_);
-        case Type::Double: return double_val_;
-        case Type::Boolean: return bool_val_ ? 1.0 : 0.0;
-        case Type::String: return std::stod(str_val_);
-        case Type::Null: throw std::runtime_error("Cannot convert NULL to double");
-        default: throw std::runtime_error("Invalid type conversion to double");
+    
+    LatencyHistogram* fetch_histogram() const {
+        return metrics_ ? &metrics_->fetch_time : nullptr;
     }
-}
-
-template<>
-inline std::string Value::as<std::string>() const {
-    switch (type_) {
-        case Type::Integer: return std::to_string(int_val_);
-        case Type::Long: return std::to_string(long_val_);
-        case Type::Double: return std::to_string(double_val_);
-        case Type::Boolean: return bool_val_ ? "true" : "false";
-        case Type::String: return str_val_;
-        case Type::Timestamp: {
-            // 将时间戳转换为字符串
-            auto tt = std::chrono::system_clock::to_time_t(timestamp_val_);
-            std::tm* tm = std::localtime(&tt);
-            std::ostringstream oss;
-            oss << std::put_time(tm, "%Y-%m-%d %H:%M:%S");
-            return oss.str();
+    
+    // 按编译期类型获取结果
+    template<typename T>
+    std::vector<T> fetch_typed(StatementHandle& stmt) {
+        ScopedLatency timer(fetch_histogram());
+        using Mapper = RowMapper<T>;
+        using Decoder = TypedRowDecoder<typename Mapper::tuple_type>;
+        
+        BlockFetcher fetcher(stmt.get(), fetch_block_size_, Decoder::c_types(), any_column_getdata_);
+        Decoder::check_columns(fetcher);
+        
+        std::vector<T> rows;
+        while (size_t count = fetcher.fetch_block()) {
+            for (size_t r = 0; r < count; ++r) {
+                if (fetcher.row_ok(r)) {
+                    rows.push_back(Mapper::from_tuple(Decoder::decode(fetcher, r)));
+                }
+            }
         }
-        case Type::Null: return "NULL";
-        default: throw std::runtime_error("Invalid type conversion to string");
+        return rows;
     }
-}
-
-template<>
-inline bool Value::as<bool>() const {
-    switch (type_) {
-        case Type::Integer: return int_val_ != 0;
-        case Type::Long: return long_val_ != 0;
-        case Type::Double: return double_val_ != 0.0;
-        case Type::Boolean: return bool_val_;
-        case Type::String: {
-            std::string lower = str_val_;
-            std::transform(lower.begin(), lower.end(), lower.begin(), ::tolower);
-            return lower == "true" || lower == "1" || lower == "yes" || lower == "on";
+    
+    // 依次读取语句的所有结果，通过SQLMoreResults前进
+    std::vector<StatementResult> fetch_all_results(StatementHandle& stmt) {
+        std::vector<StatementResult> results;
+        while (true) {
+            StatementResult item;
+            SQLSMALLINT column_count = 0;
+            SQLNumResultCols(stmt.get(), &column_count);
+            if (column_count > 0) {
+                item.has_result_set = true;
+                item.result = fetch_results(stmt);
+            } else {
+                SQLLEN row_count = 0;
+                SQLRowCount(stmt.get(), &row_count);
+                item.affected_rows = row_count > 0 ? static_cast<size_t>(row_count) : 0;
+            }
+            results.push_back(std::move(item));
+            
+            SQLRETURN ret = SQLMoreResults(stmt.get());
+            if (ret == SQL_NO_DATA) {
+                break;
+            }
+            stmt.check(ret, "Fetch next result");
         }
-        case Type::Null: return false;
-        default: throw std::runtime_error("Invalid type conversion to bool");
+        return results;
     }
-}
-
-template<>
-inline std::chrono::system_clock::time_point Value::as<std::chrono::system_clock::time_point>() const {
-    if (type_ != Type::Timestamp) {
-        throw std::runtime_error("Cannot convert non-timestamp to time_point");
+    
+    // 获取结果集
+    ResultSet fetch_results(StatementHandle& stmt) {
+        ScopedLatency timer(fetch_histogram());
+        BlockFetcher fetcher(stmt.get(), fetch_block_size_, {}, any_column_getdata_);
+        
+        // 无结果集时列数为0
+        ResultSet result_set(fetcher.schema());
+        while (size_t rows = fetcher.fetch_block()) {
+            fetcher.append_block(result_set, rows);
+        }
+        
+        return result_set;
     }
-    return timestamp_val_;
-}
+    
+private:
+    Environment::Ptr env_;  // 必须先于conn_handle_声明，保证最后释放
+    std::unique_ptr<ConnectionHandle> conn_handle_;
+    bool connected_ = false;
+    bool auto_commit_ = true;           // 驱动当前的自动提交模式
+    bool default_auto_commit_ = true;   // 事务外语句使用的模式
+    bool in_transaction_ = false;       // 处于begin_transaction开始的事务中
+    bool transaction_dirty_ = false;    // 手动提交模式下有未提交或回滚的语句
+    size_t fetch_block_size_ = 256;
+    size_t param_batch_size_ = 1000;
+    bool any_column_getdata_ = false;        // 驱动是否支持对任意未绑定列SQLGetData
+    
+    // 预备语句LRU缓存，链表头部为最近使用
+    std::list<CachedStatement> statement_lru_;
+    std::unordered_map<std::string, std::list<CachedStatement>::iterator> statement_index_;
+    size_t statement_cache_capacity_ = 0;
+    size_t statement_cache_hits_ = 0;
+    size_t statement_cache_misses_ = 0;
+    std::chrono::steady_clock::time_point last_used_ = std::chrono::steady_clock::now();
+    std::chrono::steady_clock::time_point last_validated_ = std::chrono::steady_clock::now();
+    
+    // 直接执行复用的语句句柄
+    std::vector<std::unique_ptr<StatementHandle>> idle_statements_;
+    
+    std::shared_ptr<StatementMetrics> metrics_;
+};
 
 } // namespace odbc
 
@@ -0,0 +1,214 @@
+// 连接池借还开销基准测试
+// 连接由进程内的离线连接提供，不访问数据库，测得的只是连接池自身的借还、锁竞争与内存分配开销。
+//
+// 用法: pool_benchmark [--threads 1,2,4] [--pool-sizes 1,4,16] [--shards 1,8]
+//                      [--duration-ms 500] [--hold-us 0]
+#include "odbc_connection_pool.h"
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <new>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+// 统计全局operator new调用次数，用于计算每次借还的分配数
+std::atomic<unsigned long long> g_allocations{0};
+
+} // namespace
+
+void* operator new(std::size_t size) {
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void* p = std::malloc(size ? size : 1)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+
+namespace {
+
+struct BenchmarkOptions {
+    std::vector<size_t> threads = {1, 2, 4, 8, 16, 32, 64, 128};
+    std::vector<size_t> pool_sizes = {1, 4, 16, 64};
+    std::vector<size_t> shards = {1, 8};
+    size_t duration_ms = 500;   // 每组参数的运行时间
+    size_t hold_us = 0;         // 借出后忙等的时间，模拟持有连接做事
+};
+
+struct BenchmarkResult {
+    unsigned long long operations = 0;
+    unsigned long long timeouts = 0;
+    double elapsed_s = 0;
+    double allocations_per_op = 0;
+    odbc::PoolMetricsSnapshot metrics;
+};
+
+std::vector<size_t> parse_list(const std::string& text) {
+    std::vector<size_t> values;
+    std::stringstream ss(text);
+    std::string item;
+    while (std::getline(ss, item, ',')) {
+        if (!item.empty()) {
+            values.push_back(std::stoul(item));
+        }
+    }
+    return values;
+}
+
+BenchmarkOptions parse_options(int argc, char** argv) {
+    BenchmarkOptions options;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        std::string name = argv[i];
+        std::string value = argv[i + 1];
+        if (name == "--threads") {
+            options.threads = parse_list(value);
+        } else if (name == "--pool-sizes") {
+            options.pool_sizes = parse_list(value);
+        } else if (name == "--shards") {
+            options.shards = parse_list(value);
+        } else if (name == "--duration-ms") {
+            options.duration_ms = std::stoul(value);
+        } else if (name == "--hold-us") {
+            options.hold_us = std::stoul(value);
+        } else {
+            throw std::invalid_argument("Unknown option: " + name);
+        }
+    }
+    return options;
+}
+
+void spin_for(std::chrono::microseconds duration) {
+    auto until = std::chrono::steady_clock::now() + duration;
+    while (std::chrono::steady_clock::now() < until) {
+    }
+}
+
+BenchmarkResult run_case(size_t thread_count, size_t pool_size, size_t shard_count,
+                         const BenchmarkOptions& options) {
+    odbc::ConnectionPoolConfig config;
+    config.min_connections = pool_size;
+    config.max_connections = pool_size;
+    config.idle_shards = shard_count;
+    config.validation_interval = 3600;
+    config.eviction_interval = 3600;
+    config.test_on_borrow = false;  // 只测借还本身，不做借用校验
+    config.connection_factory = [](const odbc::ConnectionConfig&, const odbc::Environment::Ptr& env) {
+        return odbc::Connection::offline(env);
+    };
+    auto pool = std::make_shared<odbc::ConnectionPool>(config);
+
+    std::atomic<bool> start{false};
+    std::atomic<bool> stop{false};
+    std::atomic<size_t> ready{0};
+    std::vector<unsigned long long> operations(thread_count, 0);
+    std::vector<unsigned long long> timeouts(thread_count, 0);
+    std::vector<std::thread> workers;
+    auto hold = std::chrono::microseconds(options.hold_us);
+
+    for (size_t t = 0; t < thread_count; ++t) {
+        workers.emplace_back([&, t] {
+            ready++;
+            while (!start.load(std::memory_order_acquire)) {
+                std::this_thread::yield();
+            }
+            unsigned long long local_ops = 0;
+            unsigned long long local_timeouts = 0;
+            while (!stop.load(std::memory_order_relaxed)) {
+                try {
+                    auto handle = pool->get_connection(std::chrono::milliseconds(1000));
+                    if (hold.count() > 0) {
+                        spin_for(hold);
+                    }
+                    local_ops++;
+                } catch (const std::exception&) {
+                    local_timeouts++;
+                }
+            }
+            operations[t] = local_ops;
+            timeouts[t] = local_timeouts;
+        });
+    }
+
+    while (ready < thread_count) {
+        std::this_thread::yield();
+    }
+    unsigned long long allocations_before = g_allocations.load();
+    auto begin = std::chrono::steady_clock::now();
+    start.store(true, std::memory_order_release);
+    std::this_thread::sleep_for(std::chrono::milliseconds(options.duration_ms));
+    stop = true;
+    auto end = std::chrono::steady_clock::now();
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    unsigned long long allocations = g_allocations.load() - allocations_before;
+
+    BenchmarkResult result;
+    for (size_t t = 0; t < thread_count; ++t) {
+        result.operations += operations[t];
+        result.timeouts += timeouts[t];
+    }
+    result.elapsed_s = std::chrono::duration<double>(end - begin).count();
+    result.allocations_per_op = result.operations
+        ? static_cast<double>(allocations) / result.operations : 0;
+    result.metrics = pool->get_metrics();
+    return result;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    BenchmarkOptions options;
+    try {
+        options = parse_options(argc, argv);
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << std::endl;
+        return 2;
+    }
+
+    std::cout << "连接池借还基准测试 (每组 " << options.duration_ms << " ms, 持有 "
+              << options.hold_us << " us)" << std::endl;
+    std::cout << std::left
+              << std::setw(8) << "threads" << std::setw(8) << "pool" << std::setw(8) << "shards"
+              << std::right
+              << std::setw(14) << "ops/s" << std::setw(12) << "ns/op"
+              << std::setw(12) << "alloc/op" << std::setw(12) << "wait_p50"
+              << std::setw(12) << "wait_p99" << std::setw(10) << "timeouts" << std::endl;
+
+    for (size_t shard_count : options.shards) {
+        for (size_t pool_size : options.pool_sizes) {
+            for (size_t thread_count : options.threads) {
+                BenchmarkResult result;
+                try {
+                    result = run_case(thread_count, pool_size, shard_count, options);
+                } catch (const std::exception& e) {
+                    std::cerr << "基准测试失败: " << e.what() << std::endl;
+                    return 1;
+                }
+                double ops_per_s = result.operations / result.elapsed_s;
+                // 每个线程每次借还的平均耗时
+                double ns_per_op = result.operations
+                    ? result.elapsed_s * 1e9 * thread_count / result.operations : 0;
+                std::cout << std::left
+                          << std::setw(8) << thread_count << std::setw(8) << pool_size
+                          << std::setw(8) << shard_count
+                          << std::right << std::fixed
+                          << std::setw(14) << std::setprecision(0) << ops_per_s
+                          << std::setw(12) << std::setprecision(1) << ns_per_op
+                          << std::setw(12) << std::setprecision(3) << result.allocations_per_op
+                          << std::setw(10) << result.metrics.borrow_wait.percentile_us(0.5) << "us"
+                          << std::setw(10) << result.metrics.borrow_wait.percentile_us(0.99) << "us"
+                          << std::setw(10) << result.timeouts << std::endl;
+            }
+        }
+    }
+    return 0;
+}